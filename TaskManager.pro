@@ -1,28 +1,61 @@
+# 使用QPromise、QList即QVector等Qt 6接口
+lessThan(QT_MAJOR_VERSION, 6): error("TaskManager需要Qt 6或更高版本（当前为Qt $$QT_VERSION）")
+
 QT += core gui sql printsupport widgets
-QT += charts
+QT += charts concurrent
 greaterThan(QT_MAJOR_VERSION, 4): QT += widgets
 
-CONFIG += c++11
+CONFIG += c++17
 
 SOURCES += \
     archivedialog.cpp \
+    asyncdatabase.cpp \
+    connectionpool.cpp \
     csvexporter.cpp \
     databasemanager.cpp \
+    deadlinequeue.cpp \
+    livesearchworker.cpp \
     main.cpp \
     mainwindow.cpp \
+    notificationcenter.cpp \
     pdfexporter.cpp \
+    reminderscheduler.cpp \
     reminderworker.cpp \
     statisticdialog.cpp \
+    task.cpp \
+    taskbitmap.cpp \
+    taskbitmapindex.cpp \
+    taskcolumns.cpp \
+    taskchangenotifier.cpp \
+    taskpager.cpp \
+    taskquery.cpp \
+    tasksearchindex.cpp \
+    taskstore.cpp \
     tasktablemodel.cpp
 
 HEADERS += \
     archivedialog.h \
+    asyncdatabase.h \
+    connectionpool.h \
     csvexporter.h \
     databasemanager.h \
+    deadlinequeue.h \
+    livesearchworker.h \
     mainwindow.h \
+    notificationcenter.h \
     pdfexporter.h \
+    reminderscheduler.h \
     reminderworker.h \
     statisticdialog.h \
+    task.h \
+    taskbitmap.h \
+    taskbitmapindex.h \
+    taskcolumns.h \
+    taskchangenotifier.h \
+    taskpager.h \
+    taskquery.h \
+    tasksearchindex.h \
+    taskstore.h \
     tasktablemodel.h
 
 FORMS += \
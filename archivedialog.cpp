@@ -1,6 +1,7 @@
 #include "archivedialog.h"
 #include "ui_archivedialog.h"
 #include "databasemanager.h"
+#include "asyncdatabase.h"
 #include <QMessageBox>
 #include <QHeaderView>
 #include <QModelIndex>
@@ -59,13 +60,17 @@ void ArchiveDialog::on_btnRestore_clicked()
         return;
     }
 
-    if (DatabaseManager::instance().restoreTaskFromArchive(task.id)) {
-        QMessageBox::information(this, "成功", "任务恢复成功！");
-        m_archivedTableModel->loadArchivedTasks(); // 刷新归档列表
-        this->accept();
-    } else {
-        QMessageBox::critical(this, "失败", "任务恢复失败！");
-    }
+    setActionsEnabled(false);
+    AsyncDatabase::whenReady(AsyncDatabase::instance().restoreTaskFromArchive(task.id), this, [this](bool success) {
+        setActionsEnabled(true);
+        if (success) {
+            QMessageBox::information(this, "成功", "任务恢复成功！");
+            m_archivedTableModel->loadArchivedTasks(); // 刷新归档列表
+            this->accept();
+        } else {
+            QMessageBox::critical(this, "失败", "任务恢复失败！");
+        }
+    });
 }
 
 // 永久删除任务（匹配UI btnPermanentDelete）
@@ -94,12 +99,22 @@ void ArchiveDialog::on_btnPermanentDelete_clicked()
         return;
     }
 
-    if (DatabaseManager::instance().deleteTaskPermanently(task.id)) {
-        QMessageBox::information(this, "成功", "任务永久删除成功！");
-        m_archivedTableModel->loadArchivedTasks(); // 刷新归档列表
-    } else {
-        QMessageBox::critical(this, "失败", "任务永久删除失败！");
-    }
+    setActionsEnabled(false);
+    AsyncDatabase::whenReady(AsyncDatabase::instance().deleteTaskPermanently(task.id), this, [this](bool success) {
+        setActionsEnabled(true);
+        if (success) {
+            QMessageBox::information(this, "成功", "任务永久删除成功！");
+            m_archivedTableModel->loadArchivedTasks(); // 刷新归档列表
+        } else {
+            QMessageBox::critical(this, "失败", "任务永久删除失败！");
+        }
+    });
+}
+
+void ArchiveDialog::setActionsEnabled(bool enabled)
+{
+    ui->btnRestore->setEnabled(enabled);
+    ui->btnPermanentDelete->setEnabled(enabled);
 }
 
 // 关闭对话框（匹配UI btnClose）
@@ -7,6 +7,7 @@
 #include <QHeaderView>
 #include <QModelIndex>
 #include "databasemanager.h" // 包含Task结构体
+#include "taskpager.h"
 
 namespace Ui {
 class ArchiveDialog;
@@ -22,7 +23,7 @@ public:
     // 重写模型核心方法
     int rowCount(const QModelIndex &parent = QModelIndex()) const override {
         Q_UNUSED(parent);
-        return m_archivedTasks.count();
+        return m_pager.rowCount();
     }
 
     int columnCount(const QModelIndex &parent = QModelIndex()) const override {
@@ -31,20 +32,21 @@ public:
     }
 
     QVariant data(const QModelIndex &index, int role = Qt::DisplayRole) const override {
-        if (!index.isValid() || index.row() >= m_archivedTasks.count()) {
+        const Task* row = index.isValid() ? m_pager.taskAt(index.row()) : nullptr;
+        if (!row) {
             return QVariant();
         }
 
-        const Task& task = m_archivedTasks.at(index.row());
+        const Task& task = *row;
         if (role == Qt::DisplayRole) {
             switch (index.column()) {
             case 0: return task.title;
-            case 1: return task.category;
-            case 2: return task.priority;
+            case 1: return taskCategoryName(task.category);
+            case 2: return taskPriorityName(task.priority);
             case 3: return task.dueTime.toString("yyyy-MM-dd HH:mm:ss");
-            case 4: return task.status == 0 ? "未完成" : "已完成";
-            case 5: return QString("%1%").arg(task.progress);
-            case 6: return DatabaseManager::instance().getTagsForTask(task.id).join(", ");
+            case 4: return taskStatusName(task.status);
+            case 5: return QString("%1%").arg(int(task.progress));
+            case 6: return m_pager.tagsAt(index.row()).join(", "); // 按页批量装入，不逐行查询
             default: return QVariant();
             }
         }
@@ -67,17 +69,37 @@ public:
         return QVariant();
     }
 
-    // 加载归档任务
+    // 分页加载：视图滚动到末尾时取下一页
+    bool canFetchMore(const QModelIndex &parent) const override {
+        return !parent.isValid() && m_pager.canFetchMore();
+    }
+
+    void fetchMore(const QModelIndex &parent) override {
+        if (!canFetchMore(parent)) return;
+        const QList<Task> page = m_pager.loadNextPage();
+        if (page.isEmpty()) {
+            m_pager.appendPage(page);
+            return;
+        }
+        const int first = m_pager.rowCount();
+        beginInsertRows(QModelIndex(), first, first + page.count() - 1);
+        m_pager.appendPage(page);
+        endInsertRows();
+    }
+
+    // 加载归档任务（只取第一页，其余按需分页加载）
     void loadArchivedTasks() {
         beginResetModel();
-        m_archivedTasks = DatabaseManager::instance().getAllArchivedTasks();
+        m_pager.reset(TaskQuery().archived(true));
+        m_pager.appendPage(m_pager.loadNextPage());
         endResetModel();
     }
 
     // 获取指定行任务
     Task getTaskAt(int row) const {
-        if (row >= 0 && row < m_archivedTasks.count()) {
-            return m_archivedTasks.at(row);
+        const Task* task = m_pager.taskAt(row);
+        if (task) {
+            return *task;
         }
         Task emptyTask;
         emptyTask.id = -1;
@@ -85,7 +107,7 @@ public:
     }
 
 private:
-    QList<Task> m_archivedTasks; // 归档任务列表
+    TaskPager m_pager; // 归档任务（按ID倒序分页，标签随页装入）
 };
 
 // 归档对话框（整合模型，无需独立头文件）
@@ -105,6 +127,9 @@ private slots:
 private:
     Ui::ArchiveDialog *ui;
     ArchivedTableModel *m_archivedTableModel; // 内部模型对象，无需独立文件
+
+    // 恢复或删除请求执行期间禁用两个操作按钮，防止对同一任务重复提交
+    void setActionsEnabled(bool enabled);
 };
 
 #endif // ARCHIVEDIALOG_H
@@ -0,0 +1,149 @@
+#include "asyncdatabase.h"
+#include <QDebug>
+
+AsyncDatabase::AsyncDatabase()
+    : m_nextSeq(0)
+    , m_stopping(false)
+    , m_thread(nullptr)
+{
+}
+
+AsyncDatabase::~AsyncDatabase()
+{
+    shutdown();
+}
+
+bool AsyncDatabase::enqueue(Priority priority, Access access, std::function<void()> job)
+{
+    QMutexLocker locker(&m_mutex);
+    if (m_stopping) {
+        qDebug() << "数据库线程已关闭，任务被取消";
+        return false;
+    }
+    if (!m_thread) {
+        m_thread = QThread::create([this]() { runLoop(); });
+        m_thread->setObjectName("DatabaseThread");
+        m_thread->start();
+    }
+
+    Job entry;
+    entry.seq = m_nextSeq++;
+    entry.caller = QThread::currentThread();
+    entry.access = access;
+    entry.run = job;
+    m_queues[priority].enqueue(entry);
+    m_wake.wakeOne();
+    return true;
+}
+
+AsyncDatabase::Job AsyncDatabase::takeNextJob()
+{
+    QQueue<Job>& interactive = m_queues[Interactive];
+    const QQueue<Job>& background = m_queues[Background];
+    if (!interactive.isEmpty()) {
+        // 交互任务越过后台任务的前提：同一调用方先提交的后台任务中没有与之冲突的（任一方为写入）
+        const Job& next = interactive.head();
+        bool blocked = false;
+        for (const Job& earlier : background) {
+            if (earlier.seq > next.seq) break;
+            if (earlier.caller == next.caller && (earlier.access == Write || next.access == Write)) {
+                blocked = true;
+                break;
+            }
+        }
+        // 被阻挡时按后台通道顺序执行，直到冲突的任务完成
+        if (!blocked) return interactive.dequeue();
+    }
+    return m_queues[Background].dequeue();
+}
+
+void AsyncDatabase::runLoop()
+{
+    for (;;) {
+        std::function<void()> job;
+        {
+            QMutexLocker locker(&m_mutex);
+            while (m_queues[Interactive].isEmpty() && m_queues[Background].isEmpty() && !m_stopping) {
+                m_wake.wait(&m_mutex);
+            }
+            if (m_queues[Interactive].isEmpty() && m_queues[Background].isEmpty()) break; // 已关闭且队列已清空
+            job = takeNextJob().run;
+        }
+        job();
+    }
+    // 在本线程内关闭其连接池连接
+    DatabaseManager::instance().releaseThreadConnection();
+}
+
+void AsyncDatabase::shutdown()
+{
+    QThread* thread = nullptr;
+    {
+        QMutexLocker locker(&m_mutex);
+        if (m_stopping) return;
+        m_stopping = true;
+        thread = m_thread;
+        m_thread = nullptr;
+        m_wake.wakeAll();
+    }
+    if (thread) {
+        thread->wait();
+        delete thread;
+        qDebug() << "数据库线程已结束";
+    }
+}
+
+QFuture<TaskStats> AsyncDatabase::taskStats()
+{
+    return run(Interactive, Read, []() { return DatabaseManager::instance().getTaskStats(); });
+}
+
+QFuture<QStringList> AsyncDatabase::allDistinctTags()
+{
+    return run(Interactive, Read, []() { return DatabaseManager::instance().getAllDistinctTags(); });
+}
+
+QFuture<QList<TaskSearchHit>> AsyncDatabase::searchTasks(const QString& keyword)
+{
+    return run(Interactive, Read, [keyword]() { return DatabaseManager::instance().searchTasks(keyword); });
+}
+
+QFuture<bool> AsyncDatabase::saveTask(const Task& task, const QStringList& tags, bool isEdit)
+{
+    return run(Interactive, Write, [task, tags, isEdit]() -> bool {
+        DatabaseManager& db = DatabaseManager::instance();
+        Task saved = task;
+        // 任务与标签在同一事务中写入，只提交一次
+        DatabaseManager::TransactionGuard transaction;
+        bool success = isEdit ? db.updateTask(saved) : db.addTask(saved, &saved.id);
+        // 标签写入失败时不提交，任务的修改随事务一起回滚
+        if (success && saved.id != -1) {
+            success = db.addTagsForTask(saved.id, tags);
+        }
+        if (success && transaction.isActive()) {
+            success = transaction.commit();
+        }
+        return success;
+    });
+}
+
+QFuture<bool> AsyncDatabase::deleteTask(int taskId)
+{
+    return run(Interactive, Write, [taskId]() { return DatabaseManager::instance().deleteTask(taskId); });
+}
+
+QFuture<bool> AsyncDatabase::archiveCompletedTasks()
+{
+    // 批量写入：可被交互读取越过，但同一调用方之后的读取仍排在其后
+    return run(Background, Write, []() { return DatabaseManager::instance().archiveCompletedTasks(); });
+}
+
+QFuture<bool> AsyncDatabase::restoreTaskFromArchive(int taskId)
+{
+    return run(Interactive, Write, [taskId]() { return DatabaseManager::instance().restoreTaskFromArchive(taskId); });
+}
+
+QFuture<bool> AsyncDatabase::deleteTaskPermanently(int taskId)
+{
+    return run(Interactive, Write, [taskId]() { return DatabaseManager::instance().deleteTaskPermanently(taskId); });
+}
@@ -0,0 +1,120 @@
+#ifndef ASYNCDATABASE_H
+#define ASYNCDATABASE_H
+
+#include <QObject>
+#include <QThread>
+#include <QMutex>
+#include <QWaitCondition>
+#include <QQueue>
+#include <QFuture>
+#include <QFutureWatcher>
+#include <QPromise>
+#include <QSharedPointer>
+#include <functional>
+#include "databasemanager.h"
+
+// 异步数据库接口：界面线程把数据库调用排入专用数据库线程执行，立即返回QFuture，不阻塞绘制
+// 两条通道：交互通道（用户正在等待的读取与写入）先于后台通道（批量、耗时任务）出队，每条通道内先进先出；
+// 交互任务不越过同一调用方（提交线程）先提交的、与之冲突（任一方为写入）的后台任务，
+// 因此读取总能看到同一调用方先提交的写入。不访问数据库的计算（如报表聚合）不要排入此队列。
+// 数据库线程持有自己的连接池连接，线程结束时释放。结果用whenReady()回到调用方线程处理
+class AsyncDatabase
+{
+public:
+    enum Priority {
+        Interactive = 0, // 用户正在等待的请求（统计面板、搜索、标签列表、单个任务的写入）
+        Background = 1,  // 批量或耗时任务（如批量归档），可被交互任务越过
+        PriorityCount
+    };
+    enum Access {
+        Read,
+        Write
+    };
+
+    static AsyncDatabase& instance() {
+        static AsyncDatabase instance;
+        return instance;
+    }
+
+    // 在数据库线程中执行fn（须有返回值），返回其结果的QFuture；access用于判断与其他任务的先后约束；
+    // 任务开始执行前调用QFuture::cancel()可跳过该任务
+    template <typename Fn>
+    auto run(Priority priority, Access access, Fn fn) -> QFuture<decltype(fn())>;
+
+    // 常用调用的异步版本（语义与DatabaseManager同名方法一致）
+    QFuture<TaskStats> taskStats();
+    QFuture<QStringList> allDistinctTags();
+    QFuture<QList<TaskSearchHit>> searchTasks(const QString& keyword);
+    // 任务与标签在同一事务中写入（isEdit为true时更新，否则新增）
+    QFuture<bool> saveTask(const Task& task, const QStringList& tags, bool isEdit);
+    QFuture<bool> deleteTask(int taskId);
+    QFuture<bool> archiveCompletedTasks();
+    QFuture<bool> restoreTaskFromArchive(int taskId);
+    QFuture<bool> deleteTaskPermanently(int taskId);
+
+    // 执行完已排队的全部任务后结束数据库线程（关闭数据库前调用）；之后提交的任务直接取消
+    void shutdown();
+
+    // future完成后在context所在线程调用handler(结果)；context先销毁或任务被取消时不调用
+    template <typename T, typename Handler>
+    static void whenReady(const QFuture<T>& future, QObject* context, Handler handler);
+
+private:
+    struct Job {
+        quint64 seq; // 提交顺序
+        QThread* caller; // 提交任务的线程
+        Access access;
+        std::function<void()> run;
+    };
+
+    AsyncDatabase();
+    ~AsyncDatabase();
+    AsyncDatabase(const AsyncDatabase&) = delete;
+    AsyncDatabase& operator=(const AsyncDatabase&) = delete;
+
+    bool enqueue(Priority priority, Access access, std::function<void()> job); // 已关闭时返回false
+    Job takeNextJob(); // 按通道与先后约束取出下一个任务（调用方持有m_mutex且队列非空）
+    void runLoop(); // 数据库线程主循环
+
+    QMutex m_mutex;
+    QWaitCondition m_wake;
+    QQueue<Job> m_queues[PriorityCount]; // 每条通道一个先进先出队列
+    quint64 m_nextSeq;
+    bool m_stopping;
+    QThread* m_thread; // 首次提交任务时启动
+};
+
+template <typename Fn>
+auto AsyncDatabase::run(Priority priority, Access access, Fn fn) -> QFuture<decltype(fn())>
+{
+    typedef decltype(fn()) Result;
+    QSharedPointer<QPromise<Result>> promise(new QPromise<Result>);
+    QFuture<Result> future = promise->future();
+    promise->start();
+    const bool queued = enqueue(priority, access, [promise, fn]() {
+        if (!promise->isCanceled()) {
+            promise->addResult(fn());
+        }
+        promise->finish();
+    });
+    if (!queued) {
+        future.cancel();
+        promise->finish();
+    }
+    return future;
+}
+
+template <typename T, typename Handler>
+void AsyncDatabase::whenReady(const QFuture<T>& future, QObject* context, Handler handler)
+{
+    QFutureWatcher<T>* watcher = new QFutureWatcher<T>(context);
+    QObject::connect(watcher, &QFutureWatcher<T>::finished, context, [watcher, handler]() {
+        if (watcher->future().isResultReadyAt(0)) {
+            handler(watcher->future().result());
+        }
+        watcher->deleteLater();
+    });
+    watcher->setFuture(future);
+}
+
+#endif // ASYNCDATABASE_H
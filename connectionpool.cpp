@@ -0,0 +1,207 @@
+#include "connectionpool.h"
+#include <QDebug>
+#include <QSqlError>
+
+struct ConnectionPool::PooledConnection {
+    QSqlDatabase db;
+    StatementCache statements; // 已预编译语句
+    int generation = 0; // 已应用的配置版本
+    int leaseDepth = 0; // 当前线程持有的租约层数
+    int writerDepth = 0; // 其中写租约的层数
+
+    ~PooledConnection()
+    {
+        // 先释放语句再关闭连接，否则removeDatabase会提示连接仍在使用
+        statements = StatementCache();
+        QString name = db.connectionName();
+        db.close();
+        db = QSqlDatabase();
+        QSqlDatabase::removeDatabase(name);
+    }
+};
+
+struct ConnectionPool::ThreadConnections {
+    QHash<ConnectionPool*, PooledConnection*> connections;
+
+    ~ThreadConnections()
+    {
+        for (QHash<ConnectionPool*, PooledConnection*>::const_iterator it = connections.constBegin();
+             it != connections.constEnd(); ++it) {
+            it.key()->closeConnection(it.value());
+            delete it.value();
+        }
+    }
+};
+
+ConnectionPool::ThreadConnections& ConnectionPool::threadConnections()
+{
+    // 每个线程一份，线程退出时自动关闭该线程的全部连接
+    static thread_local ThreadConnections threadConnections;
+    return threadConnections;
+}
+
+ConnectionPool::ConnectionPool(int maxReaders)
+    : m_maxReaders(qMax(1, maxReaders))
+    , m_readers(m_maxReaders)
+    , m_writer(1)
+    , m_generation(1)
+    , m_openConnections(0)
+    , m_nextConnectionId(0)
+{
+}
+
+void ConnectionPool::setup(const QString& dbPath, const QString& namePrefix, const Configurator& configurator)
+{
+    m_dbPath = dbPath;
+    m_namePrefix = namePrefix;
+    m_configurator = configurator;
+}
+
+void ConnectionPool::setDatabasePath(const QString& dbPath)
+{
+    m_dbPath = dbPath;
+}
+
+void ConnectionPool::invalidateConfiguration()
+{
+    m_generation.fetchAndAddOrdered(1);
+}
+
+void ConnectionPool::releaseThreadConnection()
+{
+    ThreadConnections& threadConnections = ConnectionPool::threadConnections();
+    PooledConnection* connection = threadConnections.connections.value(this);
+    if (!connection) return;
+    if (connection->leaseDepth > 0) {
+        qDebug() << "连接仍有未归还的租约，暂不释放：" << connection->db.connectionName();
+        return;
+    }
+    threadConnections.connections.remove(this);
+    closeConnection(connection);
+    delete connection;
+}
+
+int ConnectionPool::maxReaders() const
+{
+    return m_maxReaders;
+}
+
+ConnectionPool::StatementCache* ConnectionPool::statementCache(const QSqlDatabase& db)
+{
+    // 线程内通常只有一两条连接，线性查找即可
+    const QString name = db.connectionName();
+    for (PooledConnection* connection : threadConnections().connections) {
+        if (connection->db.connectionName() == name) {
+            return &connection->statements;
+        }
+    }
+    return nullptr;
+}
+
+ConnectionPool::PooledConnection* ConnectionPool::threadConnection()
+{
+    // 只访问线程局部数据，签出连接无需全局锁
+    ThreadConnections& threadConnections = ConnectionPool::threadConnections();
+    PooledConnection* connection = threadConnections.connections.value(this);
+    if (!connection) {
+        connection = new PooledConnection;
+        QString name = QString("%1_%2").arg(m_namePrefix).arg(m_nextConnectionId.fetchAndAddRelaxed(1));
+        connection->db = QSqlDatabase::addDatabase("QSQLITE", name);
+        connection->db.setDatabaseName(m_dbPath);
+        threadConnections.connections.insert(this, connection);
+    }
+    return connection;
+}
+
+void ConnectionPool::openConnection(PooledConnection* connection)
+{
+    if (!connection->db.isOpen()) {
+        connection->statements = StatementCache(); // 旧连接上预编译的语句已失效
+        if (!connection->db.open()) {
+            qDebug() << "连接池打开数据库连接失败：" << connection->db.lastError().text();
+            return;
+        }
+        m_openConnections.ref();
+        connection->generation = 0; // 重新打开的连接需要重新配置
+    }
+
+    // 新建连接或配置变更后，在该连接上（重新）应用配置
+    int generation = m_generation.loadAcquire();
+    if (connection->generation != generation) {
+        if (m_configurator) {
+            m_configurator(connection->db);
+        }
+        connection->generation = generation;
+    }
+}
+
+void ConnectionPool::closeConnection(PooledConnection* connection)
+{
+    if (!connection->db.isOpen()) return;
+    // 先释放语句再关闭连接
+    connection->statements = StatementCache();
+    {
+        // 按本连接执行过的查询，为可能受益的表更新统计信息（通常什么也不做）
+        QSqlQuery query(connection->db);
+        if (!query.exec("PRAGMA optimize")) {
+            qDebug() << "更新查询统计信息失败：" << query.lastError().text();
+        }
+    }
+    connection->db.close();
+    m_openConnections.deref();
+}
+
+void ConnectionPool::trimConnection(PooledConnection* connection)
+{
+    // 同时在用的连接最多maxReaders + 1条，空闲连接超出这个数时不再保留
+    if (m_openConnections.loadAcquire() > m_maxReaders + 1) {
+        closeConnection(connection);
+    }
+}
+
+ConnectionPool::Lease::Lease(ConnectionPool& pool, Role role)
+    : m_pool(pool)
+    , m_role(role)
+    , m_connection(pool.threadConnection())
+    , m_acquired(false)
+{
+    // 先取得名额再打开连接：同时打开并在用的连接数受名额限制
+    if (m_role == Writer) {
+        // 写租约全局唯一；同一线程内的嵌套写租约直接复用
+        if (m_connection->writerDepth == 0) {
+            m_pool.m_writer.acquire();
+            m_acquired = true;
+        }
+        ++m_connection->writerDepth;
+    } else if (m_connection->leaseDepth == 0) {
+        // 线程已持有任意租约时（包括写租约）读取不再占用读名额，避免自身等待自身
+        m_pool.m_readers.acquire();
+        m_acquired = true;
+    }
+    ++m_connection->leaseDepth;
+    m_pool.openConnection(m_connection);
+}
+
+ConnectionPool::Lease::~Lease()
+{
+    --m_connection->leaseDepth;
+    if (m_role == Writer) {
+        --m_connection->writerDepth;
+    }
+    if (m_acquired) {
+        (m_role == Writer ? m_pool.m_writer : m_pool.m_readers).release();
+    }
+    if (m_connection->leaseDepth == 0) {
+        m_pool.trimConnection(m_connection);
+    }
+}
+
+bool ConnectionPool::Lease::isValid() const
+{
+    return m_connection->db.isOpen();
+}
+
+QSqlDatabase& ConnectionPool::Lease::database()
+{
+    return m_connection->db;
+}
@@ -0,0 +1,92 @@
+#ifndef CONNECTIONPOOL_H
+#define CONNECTIONPOOL_H
+
+#include <QSqlDatabase>
+#include <QSqlQuery>
+#include <QString>
+#include <QHash>
+#include <QSemaphore>
+#include <QAtomicInt>
+#include <QSharedPointer>
+#include <functional>
+
+// 有界数据库连接池：最多maxReaders个读租约 + 1个写租约同时使用
+// Qt要求连接只能在创建它的线程中使用，因此连接按线程持有，取得名额后才打开，同时在用的连接不超过maxReaders + 1条；
+// 线程归还全部租约时，若打开的连接超过maxReaders + 1条则关闭本线程的连接，空闲连接最多保留maxReaders + 1条，
+// 其余线程的连接用完即关。线程结束（或调用releaseThreadConnection()）时关闭并移除该线程的连接
+class ConnectionPool
+{
+public:
+    enum Role {
+        Reader, // 只读租约：最多maxReaders个线程同时持有
+        Writer  // 写租约：同一时刻只有一个线程持有
+    };
+    // 新建连接或配置变更后，在连接上执行的配置回调（如应用PRAGMA）
+    typedef std::function<void(QSqlDatabase&)> Configurator;
+
+private:
+    struct PooledConnection; // 线程内的一条物理连接及其语句缓存
+    struct ThreadConnections; // 线程内各连接池的连接表，线程退出时析构
+
+public:
+    // 连接租约（RAII）：构造时签出，析构时归还；同一线程内可重入，持有写租约时读取不再占用读名额
+    class Lease
+    {
+    public:
+        Lease(ConnectionPool& pool, Role role);
+        ~Lease();
+        bool isValid() const; // 连接是否已打开
+        QSqlDatabase& database();
+
+    private:
+        Lease(const Lease&) = delete;
+        Lease& operator=(const Lease&) = delete;
+
+        ConnectionPool& m_pool;
+        Role m_role;
+        PooledConnection* m_connection;
+        bool m_acquired; // 本租约是否占用了名额（重入的内层租约不占用）
+    };
+
+    explicit ConnectionPool(int maxReaders = 4);
+
+    // 设置数据库路径、连接名前缀和配置回调（需在首次签出前调用）
+    void setup(const QString& dbPath, const QString& namePrefix, const Configurator& configurator);
+    // 更换数据库路径（需在首次签出前调用）
+    void setDatabasePath(const QString& dbPath);
+    // 配置已变更：各连接在下次签出时重新执行配置回调
+    void invalidateConfiguration();
+    // 立即关闭并移除当前线程的连接（线程退出时也会自动执行）
+    void releaseThreadConnection();
+    int maxReaders() const;
+
+    // 连接上的预编译语句缓存
+    struct StatementCache {
+        QHash<int, QSharedPointer<QSqlQuery>> byId; // 固定语句：语句编号 -> 已预编译语句
+        QHash<QString, QSharedPointer<QSqlQuery>> bySql; // 组合查询：SQL文本 -> 已预编译语句（形状数量有限）
+    };
+    // 当前线程中与db对应的预编译语句缓存（db不是本池的连接时返回nullptr）
+    static StatementCache* statementCache(const QSqlDatabase& db);
+
+private:
+    ConnectionPool(const ConnectionPool&) = delete;
+    ConnectionPool& operator=(const ConnectionPool&) = delete;
+
+    PooledConnection* threadConnection(); // 获取（必要时创建）当前线程的连接，不打开
+    void openConnection(PooledConnection* connection); // 打开连接并应用配置（已打开时只检查配置版本）
+    void closeConnection(PooledConnection* connection); // 关闭连接（保留连接名，之后可重新打开）
+    void trimConnection(PooledConnection* connection); // 线程已归还全部租约：打开的连接过多时关闭该连接
+    static ThreadConnections& threadConnections();
+
+    QString m_dbPath;
+    QString m_namePrefix;
+    Configurator m_configurator;
+    int m_maxReaders;
+    QSemaphore m_readers; // 读租约名额
+    QSemaphore m_writer;  // 写租约名额（1个）
+    QAtomicInt m_generation; // 配置版本
+    QAtomicInt m_openConnections; // 当前打开的连接数（各线程合计）
+    QAtomicInt m_nextConnectionId; // 连接名序号
+};
+
+#endif // CONNECTIONPOOL_H
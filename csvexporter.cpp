@@ -8,7 +8,7 @@ QString CsvExporter::processCsvField(const QString &field)
     return field.contains(',') ? QString("\"%1\"").arg(field) : field;
 }
 
-void CsvExporter::exportToCsv(const QList<Task> &tasks, const QString &filePath)
+void CsvExporter::exportToCsv(const DatabaseManager::TaskSource &source, const QString &filePath)
 {
     QFile file(filePath);
     if (!file.open(QIODevice::WriteOnly | QIODevice::Text)) {
@@ -21,18 +21,19 @@ void CsvExporter::exportToCsv(const QList<Task> &tasks, const QString &filePath)
     file.write("\xEF\xBB\xBF");
 
     stream << "序号,标题,分类,优先级,截止时间,状态,备注\n";
-    for (int i=0; i<tasks.count(); i++) {
-        const Task& t = tasks.at(i);
+    int row = 0;
+    source([&](const Task& t) -> bool {
         QStringList fields;
-        fields << QString::number(i+1)
+        fields << QString::number(++row)
                << processCsvField(t.title)
-               << processCsvField(t.category)
-               << processCsvField(t.priority)
+               << processCsvField(taskCategoryName(t.category))
+               << processCsvField(taskPriorityName(t.priority))
                << processCsvField(t.dueTime.toString("yyyy-MM-dd HH:mm:ss"))
-               << processCsvField(t.status == 1 ? "已完成" : "未完成")
+               << processCsvField(taskStatusName(t.status))
                << processCsvField(t.description);
         stream << fields.join(',') << "\n";
-    }
+        return true;
+    });
 
     file.close();
     qDebug() << "CSV导出成功：" << filePath;
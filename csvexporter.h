@@ -8,8 +8,8 @@
 class CsvExporter
 {
 public:
-    // 导出任务到CSV（UTF-8 with BOM）
-    static void exportToCsv(const QList<Task>& tasks, const QString& filePath);
+    // 导出任务到CSV（UTF-8 with BOM），逐行读取逐行写入，内存占用与任务数无关
+    static void exportToCsv(const DatabaseManager::TaskSource& source, const QString& filePath);
 
 private:
     // 私有构造函数（静态类）
@@ -4,28 +4,33 @@
 #include <QSqlError>
 #include <QThread>
 #include <QDir>
+#include <QFileInfo>
+#include <QStringList>
+#include <QSet>
+#include <QMutexLocker>
 
 DatabaseManager::DatabaseManager()
-    : m_connectionName("TaskManagerConnection")
+    : m_pool(qMax(2, QThread::idealThreadCount()))
+    , m_connectionName("TaskManagerConnection")
 {
 
 
     QString projectRootPath = "D:/Qt/Qt project/TaskManager";
     QDir projectDir(projectRootPath);
 
-    // 确保项目根目录存在（防止路径不存在导致创建数据库失败）
-    if (!projectDir.exists()) {
-        projectDir.mkpath(projectRootPath);
-        qDebug() << "项目根目录不存在，已自动创建：" << projectRootPath;
-    }
-
-    // 绑定项目根目录下的 task_database.db
+    // 绑定项目根目录下的 task_database.db（目录在init()打开数据库前创建）
     m_dbPath = projectDir.filePath("task_database.db");
 
     // 初始化数据库连接
     m_db = QSqlDatabase::addDatabase("QSQLITE", m_connectionName);
     m_db.setDatabaseName(m_dbPath);
     qDebug() << "已绑定数据库路径（项目根目录）：" << m_dbPath;
+
+    // 连接池连接也绑定项目根目录的数据库，新建或配置变更后应用当前持久性配置
+    m_pool.setup(m_dbPath, m_connectionName + "_Pool", [this](QSqlDatabase& db) {
+        QMutexLocker locker(&m_mutex);
+        applyConnectionPragmas(db);
+    });
 }
 
 DatabaseManager::~DatabaseManager()
@@ -35,77 +40,104 @@ DatabaseManager::~DatabaseManager()
 
 bool DatabaseManager::init()
 {
+    // 已初始化：不重复迁移和装载内存仓库（提醒线程可能已在读取）
+    if (m_store.isLoaded()) return true;
+
+    // 确保数据库所在目录存在（防止路径不存在导致创建数据库失败）
+    QDir dbDir = QFileInfo(m_dbPath).absoluteDir();
+    if (!dbDir.exists()) {
+        dbDir.mkpath(".");
+        qDebug() << "数据库目录不存在，已自动创建：" << dbDir.absolutePath();
+    }
+
     if (!m_db.open()) {
         qDebug() << "数据库打开失败：" << m_db.lastError().text();
         qDebug() << "当前数据库路径：" << m_dbPath;
         return false;
     }
 
-    QSqlQuery query(m_db);
-
-    // 检查并新增is_archived字段
-    query.exec("PRAGMA table_info(tasks)");
-    bool hasArchivedField = false;
-    while (query.next()) {
-        if (query.value(1).toString() == "is_archived") {
-            hasArchivedField = true;
-            break;
+    // 日志模式（WAL为数据库文件级的持久设置）只需在主连接上设置一次，其余为连接级设置
+    {
+        QMutexLocker locker(&m_mutex);
+        QSqlQuery query(m_db);
+        if (!query.exec(QString("PRAGMA journal_mode = %1").arg(m_durability.journalMode))) {
+            qDebug() << "设置日志模式失败：" << query.lastError().text();
         }
+        applyConnectionPragmas(m_db);
     }
-    if (!hasArchivedField) {
-        QString addArchivedFieldSql = "ALTER TABLE tasks ADD COLUMN is_archived INTEGER DEFAULT 0";
-        if (!query.exec(addArchivedFieldSql)) {
-            qDebug() << "新增is_archived字段失败：" << query.lastError().text();
-        }
+
+    // 按PRAGMA user_version执行尚未应用的迁移（已是最新版本时不做任何表结构检查）
+    if (!migrateSchema()) {
+        m_db.close();
+        return false;
     }
 
-    // 检查并新增progress字段
-    query.exec("PRAGMA table_info(tasks)");
-    bool hasProgressField = false;
-    while (query.next()) {
-        if (query.value(1).toString() == "progress") {
-            hasProgressField = true;
-            break;
+    // 没有统计信息时，规划器对"条件 + ORDER BY id DESC LIMIT"会选用(is_archived, ...)索引再整体排序，
+    // 分页查询退化为全表排序。0x10002检查全部表（不限于本连接用过的），只分析从未分析过或行数变化较大的表；
+    // 统计信息存于数据库文件，各池连接共用。池连接关闭时再按各自的查询执行PRAGMA optimize
+    {
+        QSqlQuery query(m_db);
+        if (!query.exec("PRAGMA optimize=0x10002")) {
+            qDebug() << "更新查询统计信息失败：" << query.lastError().text();
         }
     }
-    if (!hasProgressField) {
-        QString addProgressFieldSql = "ALTER TABLE tasks ADD COLUMN progress INTEGER DEFAULT 0";
-        if (!query.exec(addProgressFieldSql)) {
-            qDebug() << "新增progress字段失败：" << query.lastError().text();
-        }
+
+    prepareSearchIndex();
+
+    // 一次性装载内存任务仓库，之后的读操作不再访问数据库
+    return loadTaskStore();
+}
+
+bool DatabaseManager::migrateSchema()
+{
+    // 迁移列表：版本号必须递增，已发布的迁移不可修改，只能追加
+    struct Migration {
+        int version;
+        const char* description;
+        bool (DatabaseManager::*apply)(QSqlQuery&);
+    };
+    static const Migration migrations[] = {
+        {1, "基础表结构（tasks、tags）", &DatabaseManager::migrateToV1},
+        {2, "标签字典化（tag + task_tag）", &DatabaseManager::migrateToV2},
+        {3, "时间字段改为毫秒时间戳并建立截止时间索引", &DatabaseManager::migrateToV3},
+        {4, "建立标题、备注、标签的全文索引task_search", &DatabaseManager::migrateToV4},
+        {5, "建立触发器维护的任务计数表", &DatabaseManager::migrateToV5},
+        {6, "建立提醒记录表", &DatabaseManager::migrateToV6},
+    };
+
+    QSqlQuery query(m_db);
+    if (!query.exec("PRAGMA user_version") || !query.next()) {
+        qDebug() << "读取数据库版本失败：" << query.lastError().text();
+        return false;
     }
+    int currentVersion = query.value(0).toInt();
+    query.finish();
 
-    // 检查并新增remind_time字段
-    query.exec("PRAGMA table_info(tasks)");
-    bool hasRemindField = false;
-    while (query.next()) {
-        if (query.value(1).toString() == "remind_time") {
-            hasRemindField = true;
-            break;
+    for (const Migration& migration : migrations) {
+        if (migration.version <= currentVersion) continue;
+
+        // 每个迁移在独立事务中执行，失败则整体回滚，版本号保持不变
+        if (!m_db.transaction()) {
+            qDebug() << "开启迁移事务失败：" << m_db.lastError().text();
+            return false;
         }
-    }
-    if (!hasRemindField) {
-        QString addRemindFieldSql = "ALTER TABLE tasks ADD COLUMN remind_time DATETIME";
-        if (!query.exec(addRemindFieldSql)) {
-            qDebug() << "新增remind_time字段失败：" << query.lastError().text();
+        bool success = (this->*migration.apply)(query)
+                       && query.exec(QString("PRAGMA user_version = %1").arg(migration.version));
+        if (!success || !m_db.commit()) {
+            qDebug() << "数据库迁移失败（版本" << migration.version << migration.description << "）："
+                     << query.lastError().text();
+            m_db.rollback();
+            return false;
         }
+        currentVersion = migration.version;
+        qDebug() << "数据库已迁移至版本" << migration.version << "：" << migration.description;
     }
 
-    // 创建tags表（任务标签表，关联tasks表，不存在则创建）
-    QString createTagsTableSql = R"(
-        CREATE TABLE IF NOT EXISTS tags (
-            id INTEGER PRIMARY KEY AUTOINCREMENT,
-            task_id INTEGER NOT NULL,
-            tag_name TEXT NOT NULL,
-            FOREIGN KEY (task_id) REFERENCES tasks(id) ON DELETE CASCADE
-        )
-    )";
-    if (!query.exec(createTagsTableSql)) {
-        qDebug() << "创建tags表失败：" << query.lastError().text();
-        m_db.close();
-        return false;
-    }
+    return true;
+}
 
+bool DatabaseManager::migrateToV1(QSqlQuery& query)
+{
     // 创建tasks表（项目根目录下的核心表，不存在则创建）
     QString createTableSql = R"(
         CREATE TABLE IF NOT EXISTS tasks (
@@ -123,312 +155,1097 @@ bool DatabaseManager::init()
     )";
     if (!query.exec(createTableSql)) {
         qDebug() << "创建tasks表失败：" << query.lastError().text();
-        m_db.close();
         return false;
     }
 
+    // 旧版数据库可能缺少后加的字段：一次读取表结构后统一补齐
+    if (!query.exec("PRAGMA table_info(tasks)")) return false;
+    QSet<QString> existingColumns;
+    while (query.next()) {
+        existingColumns.insert(query.value(1).toString());
+    }
+    query.finish();
+
+    const struct {
+        const char* name;
+        const char* sql;
+    } addedColumns[] = {
+        {"is_archived", "ALTER TABLE tasks ADD COLUMN is_archived INTEGER DEFAULT 0"},
+        {"progress", "ALTER TABLE tasks ADD COLUMN progress INTEGER DEFAULT 0"},
+        {"remind_time", "ALTER TABLE tasks ADD COLUMN remind_time DATETIME"},
+    };
+    for (const auto& column : addedColumns) {
+        if (existingColumns.contains(column.name)) continue;
+        if (!query.exec(column.sql)) {
+            qDebug() << "新增" << column.name << "字段失败：" << query.lastError().text();
+            return false;
+        }
+    }
+
+    // 创建tags表（任务标签表，关联tasks表，不存在则创建）
+    QString createTagsTableSql = R"(
+        CREATE TABLE IF NOT EXISTS tags (
+            id INTEGER PRIMARY KEY AUTOINCREMENT,
+            task_id INTEGER NOT NULL,
+            tag_name TEXT NOT NULL,
+            FOREIGN KEY (task_id) REFERENCES tasks(id) ON DELETE CASCADE
+        )
+    )";
+    if (!query.exec(createTagsTableSql)) {
+        qDebug() << "创建tags表失败：" << query.lastError().text();
+        return false;
+    }
     return true;
 }
 
-void DatabaseManager::close()
+bool DatabaseManager::migrateToV2(QSqlQuery& query)
 {
-    if (m_db.isOpen()) {
-        m_db.commit(); // 强制提交所有事务，确保数据写入磁盘
-        m_db.close();
-        qDebug() << "数据库已关闭，数据已持久化到：" << m_dbPath;
+    // 标签名驻留到tag字典表，任务与标签的关系存入带索引的task_tag关联表
+    const QStringList statements = {
+        R"(CREATE TABLE IF NOT EXISTS tag (
+               id INTEGER PRIMARY KEY,
+               name TEXT NOT NULL UNIQUE
+           ))",
+        R"(CREATE TABLE IF NOT EXISTS task_tag (
+               task_id INTEGER NOT NULL REFERENCES tasks(id) ON DELETE CASCADE,
+               tag_id INTEGER NOT NULL REFERENCES tag(id),
+               PRIMARY KEY (task_id, tag_id)
+           ) WITHOUT ROWID)",
+        // 主键覆盖按任务查标签，该索引覆盖按标签查任务
+        "CREATE INDEX IF NOT EXISTS idx_task_tag_tag ON task_tag(tag_id, task_id)",
+        // 迁移旧数据：去除首尾空白、跳过空标签和已删除任务遗留的标签
+        "INSERT OR IGNORE INTO tag (name) SELECT DISTINCT trim(tag_name) FROM tags WHERE trim(tag_name) <> ''",
+        R"(INSERT OR IGNORE INTO task_tag (task_id, tag_id)
+           SELECT s.task_id, g.id
+           FROM tags s
+           JOIN tag g ON g.name = trim(s.tag_name)
+           WHERE s.task_id IN (SELECT id FROM tasks))",
+        "DROP TABLE tags",
+    };
+    for (const QString& sql : statements) {
+        if (!query.exec(sql)) {
+            qDebug() << "标签表迁移失败：" << query.lastError().text();
+            return false;
+        }
     }
+    return true;
 }
 
-QSqlDatabase DatabaseManager::getThreadSafeDatabase()
+bool DatabaseManager::migrateToV3(QSqlQuery& query)
 {
-    QMutexLocker locker(&m_mutex);
-    QString threadConnectionName = m_connectionName + "_" + QString::number((qlonglong)QThread::currentThreadId());
-    if (!QSqlDatabase::contains(threadConnectionName)) {
-        QSqlDatabase db = QSqlDatabase::addDatabase("QSQLITE", threadConnectionName);
-        db.setDatabaseName(m_dbPath); // 线程连接也绑定项目根目录的数据库
-        if (!db.open()) {
-            qDebug() << "线程安全数据库连接失败：" << db.lastError().text();
+    // SQLite不支持修改列类型：按官方步骤重建tasks表，文本时间（本地时间）转为UTC毫秒时间戳
+    const QStringList statements = {
+        R"(CREATE TABLE tasks_new (
+               id INTEGER PRIMARY KEY AUTOINCREMENT,
+               title TEXT NOT NULL,
+               category TEXT NOT NULL CHECK(category IN ('工作', '学习', '生活', '其他')),
+               priority TEXT NOT NULL CHECK(priority IN ('高', '中', '低')),
+               due_time INTEGER NOT NULL, -- 截止时间（毫秒时间戳）
+               remind_time INTEGER, -- 提醒时间（毫秒时间戳，未设置为NULL）
+               status INTEGER NOT NULL DEFAULT 0 CHECK(status IN (0, 1)),
+               description TEXT,
+               progress INTEGER DEFAULT 0,
+               is_archived INTEGER DEFAULT 0
+           ))",
+        R"(INSERT INTO tasks_new (id, title, category, priority, due_time, remind_time, status, description, progress, is_archived)
+           SELECT id, title, category, priority,
+                  COALESCE(CAST(strftime('%s', due_time, 'utc') AS INTEGER) * 1000, 0),
+                  CASE WHEN trim(COALESCE(remind_time, '')) = '' THEN NULL
+                       ELSE CAST(strftime('%s', remind_time, 'utc') AS INTEGER) * 1000 END,
+                  status, description, COALESCE(progress, 0), COALESCE(is_archived, 0)
+           FROM tasks)",
+        "DROP TABLE tasks",
+        "ALTER TABLE tasks_new RENAME TO tasks",
+        // 逾期、即将到期、时间范围查询均为该索引上的范围扫描
+        "CREATE INDEX IF NOT EXISTS idx_tasks_archived_status_due ON tasks(is_archived, status, due_time)",
+    };
+    for (const QString& sql : statements) {
+        if (!query.exec(sql)) {
+            qDebug() << "时间字段迁移失败：" << query.lastError().text();
+            return false;
         }
     }
-    return QSqlDatabase::database(threadConnectionName);
+    return true;
 }
 
-bool DatabaseManager::addTask(const Task& task)
+bool DatabaseManager::migrateToV4(QSqlQuery& query)
 {
-    QSqlDatabase db = getThreadSafeDatabase();
-    if (!db.isOpen()) return false;
+    // 索引文本由应用分词（TaskQuery::ftsDocument()），不依赖trigram分词器，也不用触发器同步；
+    // 当前SQLite不支持FTS5时只留下过期标记，迁移照常完成，关键词检索改用LIKE
+    if (!probeFullTextSearch(query)) {
+        return query.exec("CREATE TABLE IF NOT EXISTS task_search_stale (id INTEGER)");
+    }
+    return buildSearchIndex(query);
+}
 
-    QSqlQuery query(db);
-    query.prepare(R"(
-        INSERT INTO tasks (title, category, priority, due_time, remind_time, status, description, progress, is_archived)
-        VALUES (:title, :category, :priority, :due_time, :remind_time, :status, :description, :progress, :is_archived)
-    )");
-    query.bindValue(":title", task.title);
-    query.bindValue(":category", task.category);
-    query.bindValue(":priority", task.priority);
-    query.bindValue(":due_time", task.dueTime.toString("yyyy-MM-dd HH:mm:ss"));
-    query.bindValue(":remind_time", task.remindTime.toString("yyyy-MM-dd HH:mm:ss")); // 绑定提醒时间
-    query.bindValue(":status", task.status);
-    query.bindValue(":description", task.description);
-    query.bindValue(":progress", task.progress);
-    query.bindValue(":is_archived", task.is_archived);
+bool DatabaseManager::migrateToV5(QSqlQuery& query)
+{
+    // 按(归档, 状态, 分类, 优先级)分组计数，行数有上限；统计面板读取时无需扫描tasks
+    const QString decrementOld = R"(UPDATE task_counters SET count = count - 1
+               WHERE is_archived = COALESCE(old.is_archived, 0) AND status = old.status
+                 AND category = old.category AND priority = old.priority;)";
+    const QString incrementNew = R"(INSERT INTO task_counters (is_archived, status, category, priority, count)
+               VALUES (COALESCE(new.is_archived, 0), new.status, new.category, new.priority, 1)
+               ON CONFLICT (is_archived, status, category, priority) DO UPDATE SET count = count + 1;)";
+    const QStringList statements = {
+        R"(CREATE TABLE IF NOT EXISTS task_counters (
+               is_archived INTEGER NOT NULL,
+               status INTEGER NOT NULL,
+               category TEXT NOT NULL,
+               priority TEXT NOT NULL,
+               count INTEGER NOT NULL DEFAULT 0,
+               PRIMARY KEY (is_archived, status, category, priority)
+           ) WITHOUT ROWID)",
+        R"(INSERT INTO task_counters (is_archived, status, category, priority, count)
+           SELECT COALESCE(is_archived, 0), status, category, priority, COUNT(*) FROM tasks
+           GROUP BY COALESCE(is_archived, 0), status, category, priority)",
+        QString("CREATE TRIGGER IF NOT EXISTS trg_tasks_counters_insert AFTER INSERT ON tasks BEGIN %1 END")
+            .arg(incrementNew),
+        QString("CREATE TRIGGER IF NOT EXISTS trg_tasks_counters_delete AFTER DELETE ON tasks BEGIN %1 END")
+            .arg(decrementOld),
+        QString("CREATE TRIGGER IF NOT EXISTS trg_tasks_counters_update "
+                "AFTER UPDATE OF is_archived, status, category, priority ON tasks BEGIN %1 %2 END")
+            .arg(decrementOld, incrementNew),
+    };
+    for (const QString& sql : statements) {
+        if (!query.exec(sql)) {
+            qDebug() << "建立任务计数表失败：" << query.lastError().text();
+            return false;
+        }
+    }
+    return true;
+}
 
-    if (!query.exec()) {
-        qDebug() << "添加任务失败：" << query.lastError().text();
-        return false;
+bool DatabaseManager::migrateToV6(QSqlQuery& query)
+{
+    // kind：0逾期 1即将到期 2自定义提醒；at_ms为提醒所针对的截止/提醒时间
+    const QStringList statements = {
+        R"(CREATE TABLE IF NOT EXISTS task_alert_log (
+               task_id INTEGER NOT NULL,
+               kind INTEGER NOT NULL,
+               at_ms INTEGER NOT NULL,
+               notified_at INTEGER NOT NULL,
+               PRIMARY KEY (task_id, kind)
+           ) WITHOUT ROWID)",
+        // 未开启外键约束，任务删除时由触发器清理
+        R"(CREATE TRIGGER IF NOT EXISTS trg_tasks_alert_log_delete AFTER DELETE ON tasks BEGIN
+               DELETE FROM task_alert_log WHERE task_id = old.id;
+           END)",
+    };
+    for (const QString& sql : statements) {
+        if (!query.exec(sql)) {
+            qDebug() << "建立提醒记录表失败：" << query.lastError().text();
+            return false;
+        }
     }
+    return true;
+}
 
-    db.commit(); // 立即写入磁盘，确保数据不丢失
+bool DatabaseManager::probeFullTextSearch(QSqlQuery& query)
+{
+    // 部分系统SQLite未编译FTS5
+    if (!query.exec("CREATE VIRTUAL TABLE temp.fts5_probe USING fts5(x)")) {
+        qDebug() << "当前SQLite不支持FTS5，关键词检索改用LIKE扫描：" << query.lastError().text();
+        return false;
+    }
+    query.exec("DROP TABLE temp.fts5_probe");
     return true;
 }
 
-bool DatabaseManager::updateTask(const Task& task)
+bool DatabaseManager::buildSearchIndex(QSqlQuery& query)
 {
-    QSqlDatabase db = getThreadSafeDatabase();
-    if (!db.isOpen() || task.id <= 0) return false;
+    // 逐个任务写入由应用分词的索引文本（在调用方的事务中执行）
+    QSqlQuery insertQuery(m_db);
+    bool success = query.exec("DROP TABLE IF EXISTS task_search")
+                   && query.exec("CREATE VIRTUAL TABLE task_search USING fts5(title, description, tags, "
+                                 "tokenize = 'unicode61 remove_diacritics 0', prefix = '1')")
+                   && insertQuery.prepare("INSERT INTO task_search (rowid, title, description, tags) "
+                                          "VALUES (:id, :title, :description, :tags)")
+                   && query.exec("SELECT t.id, t.title, t.description, "
+                                 "(SELECT group_concat(g.name, ' ') FROM task_tag tt JOIN tag g ON g.id = tt.tag_id "
+                                 "WHERE tt.task_id = t.id) FROM tasks t");
+    while (success && query.next()) {
+        insertQuery.bindValue(":id", query.value(0).toInt());
+        insertQuery.bindValue(":title", TaskQuery::ftsDocument(query.value(1).toString()));
+        insertQuery.bindValue(":description", TaskQuery::ftsDocument(query.value(2).toString()));
+        insertQuery.bindValue(":tags", TaskQuery::ftsDocument(query.value(3).toString()));
+        success = insertQuery.exec();
+    }
+    query.finish();
+    if (!success) {
+        qDebug() << "建立全文索引失败：" << query.lastError().text() << insertQuery.lastError().text();
+        return false;
+    }
+    return query.exec("DROP TABLE IF EXISTS task_search_stale");
+}
 
-    QSqlQuery query(db);
-    query.prepare(R"(
-        UPDATE tasks
-        SET title = :title, category = :category, priority = :priority, due_time = :due_time,
-            remind_time = :remind_time, status = :status, description = :description,
-            progress = :progress, is_archived = :is_archived
-        WHERE id = :id
-    )");
-    query.bindValue(":id", task.id);
-    query.bindValue(":title", task.title);
-    query.bindValue(":category", task.category);
-    query.bindValue(":priority", task.priority);
-    query.bindValue(":due_time", task.dueTime.toString("yyyy-MM-dd HH:mm:ss"));
-    query.bindValue(":remind_time", task.remindTime.toString("yyyy-MM-dd HH:mm:ss")); // 绑定提醒时间
-    query.bindValue(":status", task.status);
-    query.bindValue(":description", task.description);
-    query.bindValue(":progress", task.progress);
-    query.bindValue(":is_archived", task.is_archived);
+void DatabaseManager::prepareSearchIndex()
+{
+    QSqlQuery query(m_db);
+    m_fullTextSearch = probeFullTextSearch(query);
+    if (!m_fullTextSearch) {
+        // 之后的写入不再同步task_search：留下标记，换用支持FTS5的SQLite后重建
+        query.exec("CREATE TABLE IF NOT EXISTS task_search_stale (id INTEGER)");
+        return;
+    }
 
-    if (!query.exec()) {
-        qDebug() << "更新任务失败：" << query.lastError().text();
-        return false;
+    // 曾在不支持FTS5的SQLite上运行过：索引已过期，按版本4迁移的方式重建
+    if (!query.exec("SELECT 1 FROM sqlite_master WHERE name = 'task_search_stale'") || !query.next()) return;
+    query.finish();
+    if (!m_db.transaction() || !buildSearchIndex(query) || !m_db.commit()) {
+        qDebug() << "重建全文索引失败，关键词检索改用LIKE扫描";
+        m_db.rollback();
+        m_fullTextSearch = false;
+        return;
     }
+    qDebug() << "全文索引已重建";
+}
 
-    db.commit(); // 立即写入磁盘，确保数据同步
-    return true;
+QVariant DatabaseManager::toEpochMs(const QDateTime& dateTime)
+{
+    return dateTime.isValid() ? QVariant(dateTime.toMSecsSinceEpoch()) : QVariant();
 }
 
-bool DatabaseManager::deleteTask(int taskId)
+QDateTime DatabaseManager::fromEpochMs(const QVariant& value)
 {
-    QSqlDatabase db = getThreadSafeDatabase();
-    if (!db.isOpen() || taskId <= 0) return false;
+    return value.isNull() ? QDateTime() : QDateTime::fromMSecsSinceEpoch(value.toLongLong());
+}
 
-    QSqlQuery query(db);
-    query.prepare("DELETE FROM tasks WHERE id = :id");
-    query.bindValue(":id", taskId);
+QString DatabaseManager::taskColumns(const QString& alias)
+{
+    static const QStringList columns = {
+        "id", "title", "category", "priority", "due_time", "remind_time",
+        "status", "description", "progress", "is_archived"
+    };
+    if (alias.isEmpty()) {
+        return columns.join(", ");
+    }
+    QStringList prefixedColumns;
+    for (const QString& column : columns) {
+        prefixedColumns.append(alias + "." + column);
+    }
+    return prefixedColumns.join(", ");
+}
 
-    if (!query.exec()) {
-        qDebug() << "删除任务失败：" << query.lastError().text();
+Task DatabaseManager::taskFromQuery(const QSqlQuery& query)
+{
+    Task task;
+    task.id = query.value(0).toInt();
+    task.title = query.value(1).toString();
+    task.category = taskCategoryFromName(query.value(2).toString());
+    task.priority = taskPriorityFromName(query.value(3).toString());
+    task.dueTime = fromEpochMs(query.value(4));
+    task.remindTime = fromEpochMs(query.value(5)); // 读取提醒时间
+    task.status = query.value(6).toInt() == 1 ? StatusCompleted : StatusUncompleted;
+    task.description = query.value(7).toString();
+    task.progress = static_cast<quint8>(qBound(0, query.value(8).toInt(), 100));
+    task.is_archived = query.value(9).toInt() ? 1 : 0;
+    return task;
+}
+
+bool DatabaseManager::loadTaskStore()
+{
+    ConnectionPool::Lease lease(m_pool, ConnectionPool::Reader);
+    if (!lease.isValid()) return false;
+    QSqlDatabase& db = lease.database();
+
+    // 归档与未归档任务一并装载
+    QSqlQuery query(db);
+    query.setForwardOnly(true);
+    if (!query.exec(QString("SELECT %1 FROM tasks").arg(taskColumns()))) {
+        qDebug() << "装载内存任务仓库失败：" << query.lastError().text();
         return false;
     }
 
-    db.commit(); // 立即写入磁盘，确保数据同步
+    QList<Task> tasks;
+    while (query.next()) {
+        tasks.append(taskFromQuery(query));
+    }
+    m_store.load(tasks);
+    qDebug() << "内存任务仓库已装载，任务数：" << tasks.count();
     return true;
 }
 
-QList<Task> DatabaseManager::getAllTasks()
+TaskSnapshotPtr DatabaseManager::taskSnapshot()
 {
-    QList<Task> taskList;
-    QSqlDatabase db = getThreadSafeDatabase();
-    if (!db.isOpen()) return taskList;
+    return m_store.snapshot();
+}
 
-    // 仅查询未归档任务，按ID倒序排列
-    QSqlQuery query("SELECT id, title, category, priority, due_time, remind_time, status, description, progress, is_archived FROM tasks WHERE is_archived = 0 ORDER BY id DESC", db);
-    while (query.next()) {
-        Task task;
-        task.id = query.value(0).toInt();
-        task.title = query.value(1).toString();
-        task.category = query.value(2).toString();
-        task.priority = query.value(3).toString();
-        task.dueTime = QDateTime::fromString(query.value(4).toString(), "yyyy-MM-dd HH:mm:ss");
-        task.remindTime = QDateTime::fromString(query.value(5).toString(), "yyyy-MM-dd HH:mm:ss"); // 读取提醒时间
-        task.status = query.value(6).toInt();
-        task.description = query.value(7).toString();
-        task.progress = query.value(8).toInt();
-        task.is_archived = query.value(9).toInt();
-        taskList.append(task);
+TaskColumnsPtr DatabaseManager::activeTaskColumns()
+{
+    return m_store.activeColumns();
+}
+
+quint64 DatabaseManager::dataVersion()
+{
+    return m_store.version();
+}
+
+TaskChangeNotifier* DatabaseManager::changeNotifier()
+{
+    return &m_changeNotifier;
+}
+
+void DatabaseManager::publishChanges(QList<TaskChange> changes)
+{
+    if (changes.isEmpty()) return;
+    // 内存仓库只接收已提交的变更，其他线程的读取不会看到未提交或随后回滚的写入
+    m_store.apply(changes);
+    emit m_changeNotifier.tasksChanged(changes);
+}
+
+void DatabaseManager::close()
+{
+    if (m_db.isOpen()) {
+        m_db.commit(); // 强制提交所有事务，确保数据写入磁盘
+        m_db.close();
+        qDebug() << "数据库已关闭，数据已持久化到：" << m_dbPath;
+    }
+}
+
+void DatabaseManager::setDatabasePath(const QString& dbPath)
+{
+    if (m_db.isOpen()) {
+        qDebug() << "数据库已打开，无法更换路径：" << dbPath;
+        return;
     }
+    m_dbPath = dbPath;
+    m_db.setDatabaseName(m_dbPath);
+    m_pool.setDatabasePath(m_dbPath);
+}
 
-    return taskList;
+void DatabaseManager::releaseThreadConnection()
+{
+    m_pool.releaseThreadConnection();
 }
 
+DurabilityProfile DurabilityProfile::safe()
+{
+    DurabilityProfile profile;
+    profile.journalMode = "DELETE";
+    profile.synchronous = "FULL";
+    return profile;
+}
 
-Task DatabaseManager::getTaskById(int taskId)
+DurabilityProfile DurabilityProfile::balanced()
 {
-    Task task;
-    QSqlDatabase db = getThreadSafeDatabase();
-    if (!db.isOpen() || taskId <= 0) return task;
+    return DurabilityProfile();
+}
 
+DurabilityProfile DurabilityProfile::fast()
+{
+    DurabilityProfile profile;
+    profile.synchronous = "OFF";
+    profile.cacheSizeKiB = 65536;
+    profile.mmapSizeBytes = 256LL * 1024 * 1024;
+    return profile;
+}
+
+void DatabaseManager::setDurabilityProfile(const DurabilityProfile& profile)
+{
+    QMutexLocker locker(&m_mutex);
+    m_durability = profile;
+    m_pool.invalidateConfiguration(); // 各池连接在下次签出时重新应用
+    if (m_db.isOpen()) {
+        QSqlQuery query(m_db);
+        query.exec(QString("PRAGMA journal_mode = %1").arg(m_durability.journalMode));
+        applyConnectionPragmas(m_db);
+    }
+}
+
+DurabilityProfile DatabaseManager::durabilityProfile()
+{
+    QMutexLocker locker(&m_mutex);
+    return m_durability;
+}
+
+void DatabaseManager::applyConnectionPragmas(QSqlDatabase& db)
+{
+    // 调用方需持有m_mutex
+    const QStringList pragmas = {
+        QString("PRAGMA synchronous = %1").arg(m_durability.synchronous),
+        QString("PRAGMA cache_size = -%1").arg(m_durability.cacheSizeKiB), // 负数表示KiB
+        QString("PRAGMA mmap_size = %1").arg(m_durability.mmapSizeBytes),
+        QString("PRAGMA temp_store = %1").arg(m_durability.tempStore),
+        QString("PRAGMA busy_timeout = %1").arg(m_durability.busyTimeoutMs),
+    };
     QSqlQuery query(db);
-    query.prepare("SELECT id, title, category, priority, due_time, remind_time, status, description, progress, is_archived FROM tasks WHERE id = :id");
-    query.bindValue(":id", taskId);
-    if (!query.exec()) {
-        qDebug() << "根据ID获取任务失败：" << query.lastError().text();
-        return task;
+    for (const QString& pragma : pragmas) {
+        if (!query.exec(pragma)) {
+            qDebug() << "应用数据库配置失败：" << pragma << query.lastError().text();
+        }
+    }
+}
+
+thread_local int DatabaseManager::TransactionGuard::s_depth = 0;
+thread_local QList<TaskChange> DatabaseManager::TransactionGuard::s_pendingChanges;
+
+DatabaseManager::TransactionGuard::TransactionGuard()
+    : m_lease(DatabaseManager::instance().m_pool, ConnectionPool::Writer)
+    , m_depth(s_depth)
+    , m_pendingMark(s_pendingChanges.count())
+    , m_active(false)
+{
+    if (!m_lease.isValid()) return;
+
+    // 最外层立即获取写锁；嵌套层使用保存点，可单独回滚
+    QSqlQuery query(m_lease.database());
+    QString sql = (m_depth == 0) ? QString("BEGIN IMMEDIATE") : QString("SAVEPOINT tx_%1").arg(m_depth);
+    if (!query.exec(sql)) {
+        qDebug() << "开启事务失败：" << query.lastError().text();
+        return;
     }
+    m_active = true;
+    ++s_depth;
+}
 
-    if (query.next()) {
-        task.id = query.value(0).toInt();
-        task.title = query.value(1).toString();
-        task.category = query.value(2).toString();
-        task.priority = query.value(3).toString();
-        task.dueTime = QDateTime::fromString(query.value(4).toString(), "yyyy-MM-dd HH:mm:ss");
-        task.remindTime = QDateTime::fromString(query.value(5).toString(), "yyyy-MM-dd HH:mm:ss");
-        task.status = query.value(6).toInt();
-        task.description = query.value(7).toString();
-        task.progress = query.value(8).toInt();
-        task.is_archived = query.value(9).toInt();
+DatabaseManager::TransactionGuard::~TransactionGuard()
+{
+    // 未显式提交即离开作用域：回滚
+    if (m_active) {
+        rollback();
     }
+}
 
-    return task;
+bool DatabaseManager::TransactionGuard::isActive() const
+{
+    return m_active;
 }
 
-bool DatabaseManager::archiveCompletedTasks()
+bool DatabaseManager::TransactionGuard::inTransaction()
 {
-    QSqlDatabase db = getThreadSafeDatabase();
-    if (!db.isOpen()) return false;
+    return s_depth > 0;
+}
 
-    QSqlQuery query(db);
-    query.prepare("UPDATE tasks SET is_archived = 1 WHERE status = 1 AND is_archived = 0");
-    if (!query.exec()) {
-        qDebug() << "归档已完成任务失败：" << query.lastError().text();
+void DatabaseManager::TransactionGuard::deferChanges(const QList<TaskChange>& changes)
+{
+    s_pendingChanges.append(changes);
+}
+
+bool DatabaseManager::TransactionGuard::commit()
+{
+    if (!m_active) return false;
+
+    QSqlQuery query(m_lease.database());
+    QString sql = (m_depth == 0) ? QString("COMMIT") : QString("RELEASE tx_%1").arg(m_depth);
+    if (!query.exec(sql)) {
+        qDebug() << "提交事务失败：" << query.lastError().text();
+        rollback();
         return false;
     }
-
-    db.commit();
+    m_active = false;
+    --s_depth;
+
+    // 最外层提交后数据才对其他连接可见，此时（仍持有写租约）再把事务内累积的变更应用到内存仓库并发出
+    if (m_depth == 0 && !s_pendingChanges.isEmpty()) {
+        QList<TaskChange> changes;
+        changes.swap(s_pendingChanges);
+        DatabaseManager::instance().publishChanges(changes);
+    }
     return true;
 }
 
-QList<Task> DatabaseManager::getAllArchivedTasks()
+void DatabaseManager::TransactionGuard::rollback()
 {
-    QList<Task> taskList;
-    QSqlDatabase db = getThreadSafeDatabase();
-    if (!db.isOpen()) return taskList;
+    if (!m_active) return;
+
+    QSqlQuery query(m_lease.database());
+    if (m_depth == 0) {
+        query.exec("ROLLBACK");
+    } else {
+        query.exec(QString("ROLLBACK TO tx_%1").arg(m_depth));
+        query.exec(QString("RELEASE tx_%1").arg(m_depth));
+    }
+    m_active = false;
+    --s_depth;
 
-    // 仅查询归档任务，按ID倒序排列
-    QSqlQuery query("SELECT id, title, category, priority, due_time, remind_time, status, description, progress, is_archived FROM tasks WHERE is_archived = 1 ORDER BY id DESC", db);
-    while (query.next()) {
-        Task task;
-        task.id = query.value(0).toInt();
-        task.title = query.value(1).toString();
-        task.category = query.value(2).toString();
-        task.priority = query.value(3).toString();
-        task.dueTime = QDateTime::fromString(query.value(4).toString(), "yyyy-MM-dd HH:mm:ss");
-        task.remindTime = QDateTime::fromString(query.value(5).toString(), "yyyy-MM-dd HH:mm:ss");
-        task.status = query.value(6).toInt();
-        task.description = query.value(7).toString();
-        task.progress = query.value(8).toInt();
-        task.is_archived = query.value(9).toInt();
-        taskList.append(task);
+    // 丢弃本层及内层暂存的变更：它们尚未应用到内存仓库，也没有发出，无需撤销
+    while (s_pendingChanges.count() > m_pendingMark) {
+        s_pendingChanges.removeLast();
     }
+}
 
-    return taskList;
+QString DatabaseManager::statementSql(StatementId id)
+{
+    switch (id) {
+    case StmtInsertTask:
+        return R"(
+            INSERT INTO tasks (title, category, priority, due_time, remind_time, status, description, progress, is_archived)
+            VALUES (:title, :category, :priority, :due_time, :remind_time, :status, :description, :progress, :is_archived)
+        )";
+    case StmtUpdateTask:
+        return R"(
+            UPDATE tasks
+            SET title = :title, category = :category, priority = :priority, due_time = :due_time,
+                remind_time = :remind_time, status = :status, description = :description,
+                progress = :progress, is_archived = :is_archived
+            WHERE id = :id
+        )";
+    case StmtDeleteTask:
+        return "DELETE FROM tasks WHERE id = :id";
+    case StmtArchiveCompleted:
+        return "UPDATE tasks SET is_archived = 1 WHERE status = 1 AND is_archived = 0";
+    case StmtSelectCompletedActiveIds:
+        return "SELECT id FROM tasks WHERE status = 1 AND is_archived = 0";
+    case StmtRestoreTask:
+        return "UPDATE tasks SET is_archived = 0 WHERE id = :id";
+    case StmtDeleteTaskTags:
+        return "DELETE FROM task_tag WHERE task_id = :task_id";
+    case StmtInternTag:
+        return "INSERT OR IGNORE INTO tag (name) VALUES (:tag_name)";
+    case StmtAddTaskTag:
+        return "INSERT OR IGNORE INTO task_tag (task_id, tag_id) SELECT :task_id, id FROM tag WHERE name = :tag_name";
+    case StmtSelectTaskTags:
+        return "SELECT g.name FROM task_tag tt JOIN tag g ON g.id = tt.tag_id WHERE tt.task_id = :task_id";
+    case StmtSelectAllTaskTags:
+        return "SELECT tt.task_id, group_concat(g.name, char(31)) FROM task_tag tt "
+               "JOIN tag g ON g.id = tt.tag_id GROUP BY tt.task_id";
+    case StmtSelectDistinctTags:
+        return "SELECT name FROM tag WHERE EXISTS (SELECT 1 FROM task_tag tt WHERE tt.tag_id = tag.id) ORDER BY name";
+    case StmtSelectTasksByTag:
+        return QString(R"(
+            SELECT %1
+            FROM tag g
+            JOIN task_tag tt ON tt.tag_id = g.id
+            JOIN tasks t ON t.id = tt.task_id
+            WHERE g.name = :tag_name AND t.is_archived = 0
+            ORDER BY t.id DESC
+        )").arg(taskColumns("t"));
+    // status IN (...)让SQLite在(is_archived, status, due_time)索引上做范围扫描，而不是全表扫描
+    case StmtSelectDueRange:
+        return QString("SELECT %1 FROM tasks "
+                       "WHERE is_archived = 0 AND status IN (0, 1) AND due_time BETWEEN :from_ms AND :to_ms "
+                       "ORDER BY id DESC").arg(taskColumns());
+    case StmtSelectUncompletedDueRange:
+        return QString("SELECT %1 FROM tasks "
+                       "WHERE is_archived = 0 AND status = 0 AND due_time BETWEEN :from_ms AND :to_ms "
+                       "ORDER BY id DESC").arg(taskColumns());
+    case StmtCountOverdue:
+        return "SELECT COUNT(*) FROM tasks WHERE is_archived = 0 AND status = 0 AND due_time < :now_ms";
+    case StmtNextUncompletedDue:
+        return "SELECT due_time FROM tasks WHERE is_archived = 0 AND status = 0 AND due_time >= :from_ms "
+               "ORDER BY due_time LIMIT 1";
+    // 计数表最多几十行；逾期数依赖当前时间，以status = -1的一行附在末尾
+    case StmtSelectTaskStats:
+        return R"(
+            SELECT status, category, priority, count FROM task_counters WHERE is_archived = 0 AND count > 0
+            UNION ALL
+            SELECT -1, '', '', COUNT(*) FROM tasks WHERE is_archived = 0 AND status = 0 AND due_time < :now_ms
+        )";
+    case StmtSelectAlertLog:
+        return "SELECT task_id, at_ms FROM task_alert_log WHERE kind = :kind";
+    case StmtRecordAlert:
+        return "INSERT INTO task_alert_log (task_id, kind, at_ms, notified_at) "
+               "VALUES (:task_id, :kind, :at_ms, :notified_at) "
+               "ON CONFLICT (task_id, kind) DO UPDATE SET at_ms = excluded.at_ms, notified_at = excluded.notified_at";
+    case StmtInsertSearchText:
+        return "INSERT INTO task_search (rowid, title, description, tags) VALUES (:id, :title, :description, '')";
+    case StmtUpdateSearchText:
+        return "UPDATE task_search SET title = :title, description = :description WHERE rowid = :id";
+    case StmtUpdateSearchTags:
+        return "UPDATE task_search SET tags = :tags WHERE rowid = :id";
+    case StmtDeleteSearchText:
+        return "DELETE FROM task_search WHERE rowid = :id";
+    case StmtCount:
+        break;
+    }
+    return QString();
 }
 
-bool DatabaseManager::restoreTaskFromArchive(int taskId)
+DatabaseManager::CachedStatement::CachedStatement(QSqlDatabase& db, StatementId id)
+    : m_query(nullptr)
+{
+    // 缓存随连接池连接保存，连接关闭时一并释放；非池连接不缓存
+    ConnectionPool::StatementCache* cache = ConnectionPool::statementCache(db);
+    QSharedPointer<QSqlQuery> cached = cache ? cache->byId.value(id) : QSharedPointer<QSqlQuery>();
+    if (!cached) {
+        bool prepared = false;
+        cached = prepare(db, statementSql(id), &prepared);
+        if (prepared && cache) {
+            cache->byId.insert(id, cached);
+        } else {
+            m_fallback = cached;
+        }
+    }
+    m_query = cached.data();
+}
+
+DatabaseManager::CachedStatement::CachedStatement(QSqlDatabase& db, const QString& sql)
+    : m_query(nullptr)
+{
+    ConnectionPool::StatementCache* cache = ConnectionPool::statementCache(db);
+    QSharedPointer<QSqlQuery> cached = cache ? cache->bySql.value(sql) : QSharedPointer<QSqlQuery>();
+    if (!cached) {
+        bool prepared = false;
+        cached = prepare(db, sql, &prepared);
+        if (prepared && cache) {
+            cache->bySql.insert(sql, cached);
+        } else {
+            m_fallback = cached;
+        }
+    }
+    m_query = cached.data();
+}
+
+QSharedPointer<QSqlQuery> DatabaseManager::CachedStatement::prepare(QSqlDatabase& db, const QString& sql, bool* prepared)
 {
-    QSqlDatabase db = getThreadSafeDatabase();
-    if (!db.isOpen() || taskId <= 0) return false;
+    QSharedPointer<QSqlQuery> query(new QSqlQuery(db));
+    query->setForwardOnly(true);
+    *prepared = query->prepare(sql);
+    if (!*prepared) {
+        // 预编译失败不缓存，下次重新尝试；exec()会返回失败并由调用方记录错误
+        qDebug() << "预编译语句失败：" << query->lastError().text();
+    }
+    return query;
+}
+
+DatabaseManager::CachedStatement::~CachedStatement()
+{
+    // 重置语句并释放读游标（避免长期占用WAL读快照），保留已编译的执行计划
+    m_query->finish();
+}
+
+bool DatabaseManager::executeWrite(const WriteWork& work, QList<TaskChange>* changes)
+{
+    // 已处于本线程的显式事务中：直接执行，由外层事务统一提交；失败时只回滚本次写入
+    if (TransactionGuard::inTransaction()) {
+        ConnectionPool::Lease lease(m_pool, ConnectionPool::Writer);
+        if (!lease.isValid()) return false;
+        QSqlQuery query(lease.database());
+        query.exec("SAVEPOINT write_request");
+        const bool success = work(lease.database());
+        if (!success) {
+            query.exec("ROLLBACK TO write_request");
+        }
+        query.exec("RELEASE write_request");
+        if (success && changes) {
+            TransactionGuard::deferChanges(*changes);
+        }
+        return success;
+    }
+
+    // 组提交：并发的写请求排队，由当前没有在等待的线程（leader）取走整批，在一个事务中执行并只提交一次
+    WriteRequest request;
+    request.work = &work;
+    request.changes = changes;
+    QMutexLocker locker(&m_writeMutex);
+    m_pendingWrites.append(&request);
+    while (!request.done) {
+        if (m_writeLeaderActive) {
+            // 已有leader在提交，等待其完成（本请求可能已被它带走）
+            m_writeFinished.wait(&m_writeMutex);
+            continue;
+        }
+
+        m_writeLeaderActive = true;
+        QList<WriteRequest*> batch;
+        batch.swap(m_pendingWrites);
+        locker.unlock();
+        commitWriteBatch(batch);
+        locker.relock();
+        for (WriteRequest* pending : batch) {
+            pending->done = true;
+        }
+        m_writeLeaderActive = false;
+        m_writeFinished.wakeAll();
+    }
+    return request.success;
+}
+
+void DatabaseManager::commitWriteBatch(const QList<WriteRequest*>& batch)
+{
+    ConnectionPool::Lease lease(m_pool, ConnectionPool::Writer);
+    if (!lease.isValid()) return;
+    QSqlDatabase& db = lease.database();
 
     QSqlQuery query(db);
-    query.prepare("UPDATE tasks SET is_archived = 0 WHERE id = :id");
-    query.bindValue(":id", taskId);
-    if (!query.exec()) {
-        qDebug() << "恢复归档任务失败：" << query.lastError().text();
+    if (!query.exec("BEGIN IMMEDIATE")) {
+        qDebug() << "开启写事务失败：" << query.lastError().text();
+        return;
+    }
+
+    for (WriteRequest* request : batch) {
+        // 每个请求一个保存点：单个请求失败只回滚自身，不影响同批次的其他请求
+        query.exec("SAVEPOINT write_request");
+        request->success = (*request->work)(db);
+        if (!request->success) {
+            query.exec("ROLLBACK TO write_request");
+        }
+        query.exec("RELEASE write_request");
+    }
+
+    if (!query.exec("COMMIT")) {
+        qDebug() << "提交写事务失败：" << query.lastError().text();
+        query.exec("ROLLBACK");
+        for (WriteRequest* request : batch) {
+            request->success = false;
+        }
+        return;
+    }
+
+    // 提交后、归还写租约前按请求顺序同步内存仓库并发出通知，多个线程的写入不会乱序应用；
+    // 通知在执行提交的线程发出，接收方应通过队列连接处理，不要在直接连接的槽中同步写数据库
+    for (WriteRequest* request : batch) {
+        if (request->success && request->changes) {
+            publishChanges(*request->changes);
+        }
+    }
+}
+
+void DatabaseManager::bindTaskValues(QSqlQuery& query, const Task& task)
+{
+    query.bindValue(":title", task.title);
+    query.bindValue(":category", taskCategoryName(task.category));
+    query.bindValue(":priority", taskPriorityName(task.priority));
+    query.bindValue(":due_time", toEpochMs(task.dueTime));
+    query.bindValue(":remind_time", toEpochMs(task.remindTime)); // 绑定提醒时间（无效时间存NULL）
+    query.bindValue(":status", int(task.status));
+    query.bindValue(":description", task.description);
+    query.bindValue(":progress", int(task.progress));
+    query.bindValue(":is_archived", int(task.is_archived));
+}
+
+bool DatabaseManager::deleteTaskRow(QSqlDatabase& db, int taskId)
+{
+    // SQLite默认未开启外键约束，手动清理标签关联
+    CachedStatement tagQuery(db, StmtDeleteTaskTags);
+    tagQuery->bindValue(":task_id", taskId);
+    if (!tagQuery->exec()) {
+        qDebug() << "删除任务标签关联失败：" << tagQuery->lastError().text();
         return false;
     }
 
-    db.commit();
-    return true;
+    CachedStatement query(db, StmtDeleteTask);
+    query->bindValue(":id", taskId);
+    if (!query->exec()) {
+        qDebug() << "删除任务失败：" << query->lastError().text();
+        return false;
+    }
+    return writeSearchText(db, StmtDeleteSearchText, taskId, QVariantMap());
 }
 
-bool DatabaseManager::deleteTaskPermanently(int taskId)
+bool DatabaseManager::writeSearchText(QSqlDatabase& db, StatementId id, int taskId, const QVariantMap& values)
 {
-    QSqlDatabase db = getThreadSafeDatabase();
-    if (!db.isOpen() || taskId <= 0) return false;
+    // 全文索引文本需要应用分词，无法由触发器维护，随任务写入在同一事务中同步
+    if (!m_fullTextSearch) return true;
+    CachedStatement query(db, id);
+    query->bindValue(":id", taskId);
+    for (QVariantMap::const_iterator it = values.constBegin(); it != values.constEnd(); ++it) {
+        query->bindValue(it.key(), it.value());
+    }
+    if (!query->exec()) {
+        qDebug() << "同步全文索引失败：" << query->lastError().text();
+        return false;
+    }
+    return true;
+}
 
-    QSqlQuery query(db);
-    query.prepare("DELETE FROM tasks WHERE id = :id");
-    query.bindValue(":id", taskId);
-    if (!query.exec()) {
-        qDebug() << "永久删除任务失败：" << query.lastError().text();
+bool DatabaseManager::addTask(const Task& task, int* insertedId)
+{
+    QList<int> insertedIds;
+    if (!addTasks(QList<Task>() << task, &insertedIds)) {
         return false;
     }
+    if (insertedId) {
+        *insertedId = insertedIds.first();
+    }
+    return true;
+}
 
-    db.commit();
+bool DatabaseManager::addTasks(const QList<Task>& tasks, QList<int>* insertedIds)
+{
+    if (tasks.isEmpty()) return true;
+
+    QList<TaskChange> changes;
+    bool success = executeWrite([&](QSqlDatabase& db) -> bool {
+        changes.clear();
+        CachedStatement query(db, StmtInsertTask);
+        for (const Task& task : tasks) {
+            bindTaskValues(*query, task);
+            if (!query->exec()) {
+                qDebug() << "添加任务失败：" << query->lastError().text();
+                return false;
+            }
+            TaskChange change;
+            change.type = TaskChange::Inserted;
+            change.taskId = query->lastInsertId().toInt();
+            change.task = task;
+            change.task.id = change.taskId;
+            changes.append(change);
+
+            QVariantMap searchText;
+            searchText.insert(":title", TaskQuery::ftsDocument(task.title));
+            searchText.insert(":description", TaskQuery::ftsDocument(task.description));
+            if (!writeSearchText(db, StmtInsertSearchText, change.taskId, searchText)) return false;
+        }
+        return true;
+    }, &changes);
+    if (!success) return false;
+
+    if (insertedIds) {
+        insertedIds->clear();
+        for (const TaskChange& change : changes) {
+            insertedIds->append(change.taskId);
+        }
+    }
     return true;
 }
 
-bool DatabaseManager::addTagsForTask(int taskId, const QStringList& tagNames)
+bool DatabaseManager::updateTask(const Task& task)
 {
-    QSqlDatabase db = getThreadSafeDatabase();
-    if (!db.isOpen() || taskId <= 0 || tagNames.isEmpty()) return false;
+    if (task.id <= 0) return false;
+
+    TaskChange change;
+    change.type = TaskChange::Updated;
+    change.taskId = task.id;
+    change.task = task;
+    QList<TaskChange> changes = QList<TaskChange>() << change;
+    return executeWrite([&](QSqlDatabase& db) -> bool {
+        CachedStatement query(db, StmtUpdateTask);
+        query->bindValue(":id", task.id);
+        bindTaskValues(*query, task);
+        if (!query->exec()) {
+            qDebug() << "更新任务失败：" << query->lastError().text();
+            return false;
+        }
+        // 任务已被删除（与删除并发）：不发布变更，避免把已删除的任务写回内存仓库
+        if (query->numRowsAffected() <= 0) {
+            qDebug() << "更新任务失败：任务不存在，ID：" << task.id;
+            return false;
+        }
+        QVariantMap searchText;
+        searchText.insert(":title", TaskQuery::ftsDocument(task.title));
+        searchText.insert(":description", TaskQuery::ftsDocument(task.description));
+        return writeSearchText(db, StmtUpdateSearchText, task.id, searchText);
+    }, &changes);
+}
 
-    // 先删除该任务原有标签，避免重复
-    QSqlQuery delQuery(db);
-    delQuery.prepare("DELETE FROM tags WHERE task_id = :task_id");
-    delQuery.bindValue(":task_id", taskId);
-    if (!delQuery.exec()) {
-        qDebug() << "删除任务原有标签失败：" << delQuery.lastError().text();
+bool DatabaseManager::deleteTask(int taskId)
+{
+    if (taskId <= 0) return false;
+
+    TaskChange change;
+    change.type = TaskChange::Deleted;
+    change.taskId = taskId;
+    QList<TaskChange> changes = QList<TaskChange>() << change;
+    return executeWrite([&](QSqlDatabase& db) { return deleteTaskRow(db, taskId); }, &changes);
+}
+
+QList<Task> DatabaseManager::getAllTasks()
+{
+    // 直接返回内存快照（已按ID倒序，隐式共享无需拷贝）
+    return m_store.snapshot()->activeTasks;
+}
+
+
+Task DatabaseManager::getTaskById(int taskId)
+{
+    if (taskId <= 0) return Task();
+    return m_store.task(taskId);
+}
+
+bool DatabaseManager::archiveCompletedTasks()
+{
+    // 在写事务内先取出将被归档的任务ID，变更与实际更新的行一致
+    QList<TaskChange> changes;
+    return executeWrite([&](QSqlDatabase& db) -> bool {
+        changes.clear();
+        CachedStatement idQuery(db, StmtSelectCompletedActiveIds);
+        if (!idQuery->exec()) {
+            qDebug() << "查询待归档任务失败：" << idQuery->lastError().text();
+            return false;
+        }
+        while (idQuery->next()) {
+            TaskChange change;
+            change.type = TaskChange::Archived;
+            change.taskId = idQuery->value(0).toInt();
+            changes.append(change);
+        }
+
+        CachedStatement query(db, StmtArchiveCompleted);
+        if (!query->exec()) {
+            qDebug() << "归档已完成任务失败：" << query->lastError().text();
+            return false;
+        }
+        return true;
+    }, &changes);
+}
+
+QList<Task> DatabaseManager::getAllArchivedTasks()
+{
+    return m_store.snapshot()->archivedTasks;
+}
+
+bool DatabaseManager::restoreTaskFromArchive(int taskId)
+{
+    if (taskId <= 0) return false;
+
+    TaskChange change;
+    change.type = TaskChange::Restored;
+    change.taskId = taskId;
+    QList<TaskChange> changes = QList<TaskChange>() << change;
+    return executeWrite([&](QSqlDatabase& db) -> bool {
+        CachedStatement query(db, StmtRestoreTask);
+        query->bindValue(":id", taskId);
+        if (!query->exec()) {
+            qDebug() << "恢复归档任务失败：" << query->lastError().text();
+            return false;
+        }
+        return true;
+    }, &changes);
+}
+
+bool DatabaseManager::deleteTaskPermanently(int taskId)
+{
+    if (taskId <= 0) return false;
+
+    TaskChange change;
+    change.type = TaskChange::Deleted;
+    change.taskId = taskId;
+    QList<TaskChange> changes = QList<TaskChange>() << change;
+    if (!executeWrite([&](QSqlDatabase& db) { return deleteTaskRow(db, taskId); }, &changes)) {
+        qDebug() << "永久删除任务失败，任务ID：" << taskId;
         return false;
     }
+    return true;
+}
 
-    // 批量添加新标签
-    QSqlQuery addQuery(db);
-    addQuery.prepare("INSERT INTO tags (task_id, tag_name) VALUES (:task_id, :tag_name)");
+bool DatabaseManager::addTagsForTask(int taskId, const QStringList& tagNames)
+{
+    if (taskId <= 0) return false;
+
+    // 去空白、去重后的标签即为写入后的标签集合（可能为空：只删除原有标签）
+    QStringList tags;
     for (const QString& tag : tagNames) {
         QString tagTrimmed = tag.trimmed();
-        if (tagTrimmed.isEmpty()) continue; // 跳过空标签
-        addQuery.bindValue(":task_id", taskId);
-        addQuery.bindValue(":tag_name", tagTrimmed);
-        if (!addQuery.exec()) {
-            qDebug() << "添加标签失败：" << addQuery.lastError().text();
-            return false;
+        if (!tagTrimmed.isEmpty() && !tags.contains(tagTrimmed)) {
+            tags.append(tagTrimmed);
         }
     }
 
-    db.commit();
-    return true;
+    TaskChange change;
+    change.type = TaskChange::TagsChanged;
+    change.taskId = taskId;
+    change.tags = tags;
+    QList<TaskChange> changes = QList<TaskChange>() << change;
+    return executeWrite([&](QSqlDatabase& db) -> bool {
+        // 先删除该任务原有标签，避免重复
+        CachedStatement delQuery(db, StmtDeleteTaskTags);
+        delQuery->bindValue(":task_id", taskId);
+        if (!delQuery->exec()) {
+            qDebug() << "删除任务原有标签失败：" << delQuery->lastError().text();
+            return false;
+        }
+
+        // 批量添加新标签：标签名先驻留到tag字典，再写入关联表
+        CachedStatement internQuery(db, StmtInternTag);
+        CachedStatement addQuery(db, StmtAddTaskTag);
+        for (const QString& tag : tags) {
+            internQuery->bindValue(":tag_name", tag);
+            addQuery->bindValue(":task_id", taskId);
+            addQuery->bindValue(":tag_name", tag);
+            if (!internQuery->exec() || !addQuery->exec()) {
+                qDebug() << "添加标签失败：" << internQuery->lastError().text() << addQuery->lastError().text();
+                return false;
+            }
+        }
+        QVariantMap searchText;
+        searchText.insert(":tags", TaskQuery::ftsDocument(tags.join(' ')));
+        return writeSearchText(db, StmtUpdateSearchTags, taskId, searchText);
+    }, &changes);
 }
 
 QStringList DatabaseManager::getTagsForTask(int taskId)
 {
     QStringList tagList;
-    QSqlDatabase db = getThreadSafeDatabase();
-    if (!db.isOpen() || taskId <= 0) return tagList;
+    ConnectionPool::Lease lease(m_pool, ConnectionPool::Reader);
+    if (!lease.isValid() || taskId <= 0) return tagList;
+    QSqlDatabase& db = lease.database();
+
+    // 主键(task_id, tag_id)索引查找
+    CachedStatement query(db, StmtSelectTaskTags);
+    query->bindValue(":task_id", taskId);
+    if (!query->exec()) {
+        qDebug() << "获取任务标签失败：" << query->lastError().text();
+        return tagList;
+    }
+
+    while (query->next()) {
+        tagList.append(query->value(0).toString());
+    }
+
+    return tagList;
+}
+
+QHash<int, QStringList> DatabaseManager::getTagsForAllTasks()
+{
+    QHash<int, QStringList> tagMap;
+    ConnectionPool::Lease lease(m_pool, ConnectionPool::Reader);
+    if (!lease.isValid()) return tagMap;
+    QSqlDatabase& db = lease.database();
+
+    // 按任务分组拼接标签，一条查询取回全部任务的标签（char(31)为单元分隔符，不会出现在标签中）
+    CachedStatement query(db, StmtSelectAllTaskTags);
+    if (!query->exec()) {
+        qDebug() << "批量获取任务标签失败：" << query->lastError().text();
+        return tagMap;
+    }
 
+    const QChar separator(0x1F);
+    while (query->next()) {
+        tagMap.insert(query->value(0).toInt(), query->value(1).toString().split(separator, Qt::SkipEmptyParts));
+    }
+
+    return tagMap;
+}
+
+QHash<int, QStringList> DatabaseManager::getTagsForTasks(const QVector<int>& taskIds)
+{
+    QHash<int, QStringList> tagMap;
+    if (taskIds.isEmpty()) return tagMap;
+    ConnectionPool::Lease lease(m_pool, ConnectionPool::Reader);
+    if (!lease.isValid()) return tagMap;
+    QSqlDatabase& db = lease.database();
+
+    // 一页任务一条查询：task_id IN (...)在主键(task_id, tag_id)上逐个查找
+    QStringList placeholders;
+    placeholders.reserve(taskIds.count());
+    for (int i = 0; i < taskIds.count(); ++i) {
+        placeholders.append("?");
+    }
     QSqlQuery query(db);
-    query.prepare("SELECT tag_name FROM tags WHERE task_id = :task_id");
-    query.bindValue(":task_id", taskId);
+    query.setForwardOnly(true);
+    query.prepare(QString("SELECT tt.task_id, g.name FROM task_tag tt JOIN tag g ON g.id = tt.tag_id "
+                          "WHERE tt.task_id IN (%1)").arg(placeholders.join(", ")));
+    for (int taskId : taskIds) {
+        query.addBindValue(taskId);
+    }
     if (!query.exec()) {
-        qDebug() << "获取任务标签失败：" << query.lastError().text();
-        return tagList;
+        qDebug() << "批量获取任务标签失败：" << query.lastError().text();
+        return tagMap;
     }
 
     while (query.next()) {
-        tagList.append(query.value(0).toString());
+        tagMap[query.value(0).toInt()].append(query.value(1).toString());
     }
-
-    return tagList;
+    return tagMap;
 }
 
 QStringList DatabaseManager::getAllDistinctTags()
 {
     QStringList tagList;
-    QSqlDatabase db = getThreadSafeDatabase();
-    if (!db.isOpen()) return tagList;
-
-    // 获取所有不重复的标签，按名称排序
-    QSqlQuery query("SELECT DISTINCT tag_name FROM tags ORDER BY tag_name", db);
-    while (query.next()) {
-        tagList.append(query.value(0).toString());
+    ConnectionPool::Lease lease(m_pool, ConnectionPool::Reader);
+    if (!lease.isValid()) return tagList;
+    QSqlDatabase& db = lease.database();
+
+    // 获取仍被任务使用的标签：按name唯一索引顺序遍历字典，无需排序和去重
+    CachedStatement query(db, StmtSelectDistinctTags);
+    if (!query->exec()) {
+        qDebug() << "获取标签列表失败：" << query->lastError().text();
+        return tagList;
+    }
+    while (query->next()) {
+        tagList.append(query->value(0).toString());
     }
 
     return tagList;
@@ -436,110 +1253,335 @@ QStringList DatabaseManager::getAllDistinctTags()
 
 QList<Task> DatabaseManager::getTasksByTag(const QString& tagName)
 {
-    QList<Task> taskList;
-    QSqlDatabase db = getThreadSafeDatabase();
-    if (!db.isOpen() || tagName.trimmed().isEmpty()) return taskList;
+    return collectTasks([&](const TaskVisitor& visitor) {
+        return forEachTaskByTag(tagName, visitor);
+    });
+}
 
-    // 关联查询标签对应的未归档任务（新增查询remind_time）
-    QSqlQuery query(db);
-    query.prepare(R"(
-        SELECT t.id, t.title, t.category, t.priority, t.due_time, t.remind_time, t.status, t.description, t.progress, t.is_archived
-        FROM tasks t
-        JOIN tags g ON t.id = g.task_id
-        WHERE g.tag_name = :tag_name AND t.is_archived = 0
-        ORDER BY t.id DESC
-    )");
-    query.bindValue(":tag_name", tagName.trimmed());
-    if (!query.exec()) {
-        qDebug() << "根据标签筛选任务失败：" << query.lastError().text();
-        return taskList;
+QList<Task> DatabaseManager::getOverdueUncompletedTasks()
+{
+    return collectTasks([&](const TaskVisitor& visitor) {
+        return forEachOverdueUncompletedTask(visitor);
+    });
+}
+
+QList<Task> DatabaseManager::getUpcomingTasks(int withinMinutes)
+{
+    return collectTasks([&](const TaskVisitor& visitor) {
+        return forEachUpcomingTask(withinMinutes, visitor);
+    });
+}
+
+QList<Task> DatabaseManager::getTasksDueBetween(const QDateTime& start, const QDateTime& end)
+{
+    return collectTasks([&](const TaskVisitor& visitor) {
+        return forEachTaskDueBetween(start, end, visitor);
+    });
+}
+
+bool DatabaseManager::forEachTask(TaskScope scope, const TaskVisitor& visitor)
+{
+    // 快照隐式共享，遍历期间不拷贝任务列表
+    TaskSnapshotPtr snapshot = m_store.snapshot();
+    const QList<Task>& tasks = (scope == ArchivedTasks) ? snapshot->archivedTasks : snapshot->activeTasks;
+    for (const Task& task : tasks) {
+        if (!visitor(task)) break;
     }
+    return true;
+}
 
-    while (query.next()) {
-        Task task;
-        task.id = query.value(0).toInt();
-        task.title = query.value(1).toString();
-        task.category = query.value(2).toString();
-        task.priority = query.value(3).toString();
-        task.dueTime = QDateTime::fromString(query.value(4).toString(), "yyyy-MM-dd HH:mm:ss");
-        task.remindTime = QDateTime::fromString(query.value(5).toString(), "yyyy-MM-dd HH:mm:ss");
-        task.status = query.value(6).toInt();
-        task.description = query.value(7).toString();
-        task.progress = query.value(8).toInt();
-        task.is_archived = query.value(9).toInt();
-        taskList.append(task);
+bool DatabaseManager::forEachTaskByTag(const QString& tagName, const TaskVisitor& visitor)
+{
+    if (tagName.trimmed().isEmpty()) return true;
+    ConnectionPool::Lease lease(m_pool, ConnectionPool::Reader);
+    if (!lease.isValid()) return false;
+    QSqlDatabase& db = lease.database();
+
+    // 关联查询标签对应的未归档任务
+    CachedStatement query(db, StmtSelectTasksByTag);
+    query->bindValue(":tag_name", tagName.trimmed());
+    if (!query->exec()) {
+        qDebug() << "根据标签筛选任务失败：" << query->lastError().text();
+        return false;
     }
 
-    return taskList;
+    while (query->next()) {
+        if (!visitor(taskFromQuery(*query))) break;
+    }
+    return true;
 }
 
-QList<Task> DatabaseManager::getOverdueUncompletedTasks()
+bool DatabaseManager::forEachTask(const TaskQuery& taskQuery, const TaskVisitor& visitor)
 {
-    QList<Task> tasks;
-    QSqlDatabase db = getThreadSafeDatabase();
-    if (!db.isOpen()) return tasks;
+    ConnectionPool::Lease lease(m_pool, ConnectionPool::Reader);
+    if (!lease.isValid()) return false;
+    QSqlDatabase& db = lease.database();
+
+    // 条件值全部参数化，同一组条件组合的SQL文本不变，可复用预编译语句
+    QVariantMap bindings;
+    CachedStatement query(db, taskQuery.toSql(taskColumns("t"), &bindings, m_fullTextSearch));
+    for (QVariantMap::const_iterator it = bindings.constBegin(); it != bindings.constEnd(); ++it) {
+        query->bindValue(it.key(), it.value());
+    }
+    if (!query->exec()) {
+        qDebug() << "组合条件查询任务失败：" << query->lastError().text();
+        return false;
+    }
 
-    // 查询逾期未完成的未归档任务
-    QSqlQuery query(db);
-    query.prepare("SELECT id, title, category, priority, due_time, remind_time, status, description, progress, is_archived "
-                  "FROM tasks WHERE status=0 AND due_time < datetime('now') AND is_archived=0 ORDER BY id DESC");
-    if (!query.exec()) {
-        qDebug() << "获取逾期未完成任务失败：" << query.lastError().text();
-        return tasks;
+    while (query->next()) {
+        if (!visitor(taskFromQuery(*query))) break;
     }
+    return true;
+}
 
-    while (query.next()) {
-        Task task;
-        task.id = query.value(0).toInt();
-        task.title = query.value(1).toString();
-        task.category = query.value(2).toString();
-        task.priority = query.value(3).toString();
-        task.dueTime = QDateTime::fromString(query.value(4).toString(), "yyyy-MM-dd HH:mm:ss");
-        task.remindTime = QDateTime::fromString(query.value(5).toString(), "yyyy-MM-dd HH:mm:ss");
-        task.status = query.value(6).toInt();
-        task.description = query.value(7).toString();
-        task.progress = query.value(8).toInt();
-        task.is_archived = query.value(9).toInt();
-        tasks.append(task);
+QList<Task> DatabaseManager::queryTasks(const TaskQuery& taskQuery)
+{
+    return collectTasks([&](const TaskVisitor& visitor) {
+        return forEachTask(taskQuery, visitor);
+    });
+}
+
+QList<TaskSearchHit> DatabaseManager::searchTasks(const QString& text, int limit, bool withSnippets)
+{
+    QList<TaskSearchHit> hits;
+    const QString match = TaskQuery::ftsMatchExpression(text);
+    if (match.isEmpty()) return hits;
+
+    ConnectionPool::Lease lease(m_pool, ConnectionPool::Reader);
+    if (!lease.isValid()) return hits;
+    QSqlDatabase& db = lease.database();
+
+    // 有全文索引时按bm25相关度排序（标题权重最高，其次标签）；不支持FTS5时退化为LIKE扫描，按ID倒序
+    // 片段由原文生成（索引中存放的是分词后的文本），需要时一并取回标签
+    QVariantMap bindings;
+    const QString tagsColumn = withSnippets ? QString("(SELECT group_concat(g.name, ' ') FROM task_tag tt "
+                                                      "JOIN tag g ON g.id = tt.tag_id WHERE tt.task_id = t.id)")
+                                            : QString("''");
+    QString sql;
+    if (m_fullTextSearch) {
+        bindings.insert(":fts_match", match);
+        sql = QString("SELECT %1, bm25(task_search, 10.0, 1.0, 5.0) AS score, %2 "
+                      "FROM task_search JOIN tasks t ON t.id = task_search.rowid "
+                      "WHERE task_search MATCH :fts_match AND t.is_archived = 0 ORDER BY score LIMIT :limit")
+                  .arg(taskColumns("t"), tagsColumn);
+    } else {
+        sql = QString("SELECT %1, 0, %2 FROM tasks t WHERE t.is_archived = 0 AND %3 ORDER BY t.id DESC LIMIT :limit")
+                  .arg(taskColumns("t"), tagsColumn, TaskQuery::likeCondition(text, &bindings));
+    }
+    bindings.insert(":limit", limit > 0 ? limit : -1); // LIMIT -1为不限制
+
+    CachedStatement query(db, sql);
+    for (QVariantMap::const_iterator it = bindings.constBegin(); it != bindings.constEnd(); ++it) {
+        query->bindValue(it.key(), it.value());
+    }
+    if (!query->exec()) {
+        qDebug() << "全文检索任务失败：" << query->lastError().text();
+        return hits;
+    }
+
+    // 查询列之后依次为相关度与标签
+    const int scoreColumn = 10; // taskColumns()共10列
+    const QStringList terms = withSnippets ? TaskQuery::searchTerms(text) : QStringList();
+    while (query->next()) {
+        TaskSearchHit hit;
+        hit.task = taskFromQuery(*query);
+        hit.score = query->value(scoreColumn).toDouble();
+        if (withSnippets) {
+            // 依次取标题、备注、标签中的第一处命中
+            const QStringList fields = {hit.task.title, hit.task.description, query->value(scoreColumn + 1).toString()};
+            for (int i = 0; i < fields.count() && hit.snippet.isEmpty(); ++i) {
+                hit.snippet = TaskQuery::searchSnippet(fields.at(i), terms, 16);
+            }
+        }
+        hits.append(hit);
     }
+    return hits;
+}
+
+bool DatabaseManager::forEachOverdueUncompletedTask(const TaskVisitor& visitor)
+{
+    // 逾期未完成：截止时间早于当前时间的未归档未完成任务
+    return forEachTaskInDueRange(0, QDateTime::currentMSecsSinceEpoch() - 1, true, visitor);
+}
+
+bool DatabaseManager::forEachUpcomingTask(int withinMinutes, const TaskVisitor& visitor)
+{
+    // 即将到期：截止时间在[当前时间, 当前时间 + withinMinutes]内的未归档未完成任务
+    qint64 nowMs = QDateTime::currentMSecsSinceEpoch();
+    return forEachTaskInDueRange(nowMs, nowMs + qint64(withinMinutes) * 60 * 1000, true, visitor);
+}
+
+bool DatabaseManager::forEachTaskDueBetween(const QDateTime& start, const QDateTime& end, const TaskVisitor& visitor)
+{
+    if (!start.isValid() || !end.isValid() || start > end) return true;
+    return forEachTaskInDueRange(start.toMSecsSinceEpoch(), end.toMSecsSinceEpoch(), false, visitor);
+}
+
+bool DatabaseManager::forEachUncompletedTaskDueBetween(const QDateTime& start, const QDateTime& end,
+                                                       const TaskVisitor& visitor)
+{
+    if (!start.isValid() || !end.isValid() || start > end) return true;
+    return forEachTaskInDueRange(start.toMSecsSinceEpoch(), end.toMSecsSinceEpoch(), true, visitor);
+}
+
+QList<Task> DatabaseManager::collectTasks(const TaskSource& source)
+{
+    QList<Task> tasks;
+    source([&](const Task& task) -> bool {
+        tasks.append(task);
+        return true;
+    });
     return tasks;
 }
 
-int DatabaseManager::getTotalTaskCount()
+bool DatabaseManager::forEachTaskInDueRange(qint64 fromMs, qint64 toMs, bool uncompletedOnly, const TaskVisitor& visitor)
 {
-    QSqlDatabase db = getThreadSafeDatabase();
-    if (!db.isOpen()) return 0;
+    ConnectionPool::Lease lease(m_pool, ConnectionPool::Reader);
+    if (!lease.isValid()) return false;
+    QSqlDatabase& db = lease.database();
+
+    CachedStatement query(db, uncompletedOnly ? StmtSelectUncompletedDueRange : StmtSelectDueRange);
+    query->bindValue(":from_ms", fromMs);
+    query->bindValue(":to_ms", toMs);
+    if (!query->exec()) {
+        qDebug() << "按截止时间范围查询任务失败：" << query->lastError().text();
+        return false;
+    }
 
-    QSqlQuery query(db);
-    query.exec("SELECT COUNT(*) FROM tasks WHERE is_archived=0");
-    if (query.next()) {
-        return query.value(0).toInt();
+    while (query->next()) {
+        if (!visitor(taskFromQuery(*query))) break;
     }
-    return 0;
+    return true;
+}
+
+int DatabaseManager::getTotalTaskCount()
+{
+    return m_store.snapshot()->activeTasks.count();
 }
 
 int DatabaseManager::getCompletedTaskCount()
 {
-    QSqlDatabase db = getThreadSafeDatabase();
-    if (!db.isOpen()) return 0;
+    return getTaskStats().completed;
+}
+
+TaskStats DatabaseManager::getTaskStats()
+{
+    TaskStats stats;
+    ConnectionPool::Lease lease(m_pool, ConnectionPool::Reader);
+    if (!lease.isValid()) return stats;
+    QSqlDatabase& db = lease.database();
+
+    CachedStatement query(db, StmtSelectTaskStats);
+    query->bindValue(":now_ms", QDateTime::currentMSecsSinceEpoch());
+    if (!query->exec()) {
+        qDebug() << "获取任务统计失败：" << query->lastError().text();
+        return stats;
+    }
 
-    QSqlQuery query(db);
-    query.exec("SELECT COUNT(*) FROM tasks WHERE status=1 AND is_archived=0");
-    if (query.next()) {
-        return query.value(0).toInt();
+    while (query->next()) {
+        const int status = query->value(0).toInt();
+        const int count = query->value(3).toInt();
+        if (status < 0) {
+            stats.overdue = count;
+            continue;
+        }
+        stats.total += count;
+        if (status == StatusCompleted) stats.completed += count;
+        stats.byCategory[taskCategoryFromName(query->value(1).toString())] += count;
+        stats.byPriority[taskPriorityFromName(query->value(2).toString())] += count;
     }
-    return 0;
+    return stats;
+}
+
+double TaskStats::completionRate() const
+{
+    return total > 0 ? (static_cast<double>(completed) / total) * 100 : 0.0;
+}
+
+void TaskStats::accumulate(const Task& task, qint64 nowMs)
+{
+    total++;
+    if (task.status == StatusCompleted) {
+        completed++;
+    } else if (task.dueTime.isValid() && task.dueTime.toMSecsSinceEpoch() < nowMs) {
+        overdue++;
+    }
+    if (task.category < CategoryCount) byCategory[task.category]++;
+    if (task.priority < PriorityCount) byPriority[task.priority]++;
 }
 
 int DatabaseManager::getOverdueUncompletedCount()
 {
-    return getOverdueUncompletedTasks().count();
+    ConnectionPool::Lease lease(m_pool, ConnectionPool::Reader);
+    if (!lease.isValid()) return 0;
+    QSqlDatabase& db = lease.database();
+
+    // 仅在索引上计数，不物化任务列表
+    CachedStatement query(db, StmtCountOverdue);
+    query->bindValue(":now_ms", QDateTime::currentMSecsSinceEpoch());
+    if (query->exec() && query->next()) {
+        return query->value(0).toInt();
+    }
+    return 0;
+}
+
+qint64 DatabaseManager::nextUncompletedDueTime(qint64 fromMs)
+{
+    ConnectionPool::Lease lease(m_pool, ConnectionPool::Reader);
+    if (!lease.isValid()) return -1;
+    QSqlDatabase& db = lease.database();
+
+    // 在(is_archived, status, due_time)索引上定位到第一项即返回
+    CachedStatement query(db, StmtNextUncompletedDue);
+    query->bindValue(":from_ms", fromMs);
+    if (!query->exec()) {
+        qDebug() << "查询下一个截止时间失败：" << query->lastError().text();
+        return -1;
+    }
+    return query->next() ? query->value(0).toLongLong() : -1;
+}
+
+QHash<int, qint64> DatabaseManager::getAlertLog(AlertKind kind)
+{
+    QHash<int, qint64> log;
+    ConnectionPool::Lease lease(m_pool, ConnectionPool::Reader);
+    if (!lease.isValid()) return log;
+    QSqlDatabase& db = lease.database();
+
+    CachedStatement query(db, StmtSelectAlertLog);
+    query->bindValue(":kind", int(kind));
+    if (!query->exec()) {
+        qDebug() << "读取提醒记录失败：" << query->lastError().text();
+        return log;
+    }
+    while (query->next()) {
+        log.insert(query->value(0).toInt(), query->value(1).toLongLong());
+    }
+    return log;
+}
+
+bool DatabaseManager::recordAlerts(AlertKind kind, const QList<QPair<int, qint64>>& alerts)
+{
+    if (alerts.isEmpty()) return true;
+    const qint64 nowMs = QDateTime::currentMSecsSinceEpoch();
+    // 一批提醒在同一事务中写入（与其他线程的写请求合并提交）
+    return executeWrite([&](QSqlDatabase& db) -> bool {
+        CachedStatement query(db, StmtRecordAlert);
+        for (const QPair<int, qint64>& alert : alerts) {
+            query->bindValue(":task_id", alert.first);
+            query->bindValue(":kind", int(kind));
+            query->bindValue(":at_ms", alert.second);
+            query->bindValue(":notified_at", nowMs);
+            if (!query->exec()) {
+                qDebug() << "写入提醒记录失败：" << query->lastError().text();
+                return false;
+            }
+        }
+        return true;
+    });
 }
 
 double DatabaseManager::getCompletionRate()
 {
-    int total = getTotalTaskCount();
-    if (total == 0) return 0.0;
-    // 计算完成率（百分比）
-    return (static_cast<double>(getCompletedTaskCount()) / total) * 100;
+    return getTaskStats().completionRate();
 }
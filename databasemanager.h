@@ -4,45 +4,110 @@
 #include <QSqlDatabase>
 #include <QSqlQuery>
 #include <QList>
+#include <QVector>
+#include <QHash>
+#include <QPair>
+#include <QStringList>
 #include <QString>
 #include <QDateTime>
 #include <QMutex>
+#include <QWaitCondition>
+#include <QVariant>
+#include <QSharedPointer>
+#include <functional>
+#include "task.h"
+#include "taskstore.h"
+#include "connectionpool.h"
+#include "taskquery.h"
+#include "taskchangenotifier.h"
 
-struct Task {
-    int id = -1;
-    QString title;
-    QString category;
-    QString priority;
-    QDateTime dueTime;
-    QDateTime remindTime;
-    int status = 0; // 0:未完成 1:已完成
-    QString description;
-    int progress = 0; // 任务进度 0~100
-    int is_archived = 0; // 0:未归档 1:已归档
-
-    bool isValid() const { return id != -1 && !title.isEmpty(); }
+// SQLite持久性配置：在init()与每个线程连接上统一应用
+struct DurabilityProfile {
+    QString journalMode = "WAL"; // 日志模式：WAL下读不阻塞写、写不阻塞读
+    QString synchronous = "NORMAL"; // 同步级别：OFF / NORMAL / FULL / EXTRA
+    int cacheSizeKiB = 8192; // 每个连接的页缓存大小（KiB）
+    qint64 mmapSizeBytes = 64LL * 1024 * 1024; // 内存映射读取大小（0为关闭）
+    QString tempStore = "MEMORY"; // 临时表与排序存放位置：DEFAULT / FILE / MEMORY
+    int busyTimeoutMs = 5000; // 遇到锁时的等待超时（毫秒）
+
+    static DurabilityProfile safe(); // 回滚日志 + FULL：断电也不丢已提交事务
+    static DurabilityProfile balanced(); // WAL + NORMAL：默认配置，断电最多丢最近的提交
+    static DurabilityProfile fast(); // WAL + OFF + 大缓存：批量导入等可重做的场景
+};
+
+// 全文检索结果
+struct TaskSearchHit {
+    Task task;
+    double score = 0.0; // 相关度（bm25，越小越相关；不支持全文索引时为0）
+    QString snippet; // 命中片段，匹配内容用【】标出（未请求时为空）
+};
+
+// 任务统计汇总（未归档任务）
+struct TaskStats {
+    int total = 0;
+    int completed = 0;
+    int overdue = 0; // 未完成且已过截止时间
+    int byCategory[CategoryCount] = {};
+    int byPriority[PriorityCount] = {};
+
+    double completionRate() const; // 完成率（百分比）
+    // 单遍累加一个任务（用于对任意任务集合流式统计）
+    void accumulate(const Task& task, qint64 nowMs);
 };
 
 class DatabaseManager
 {
 public:
+    // 作用域事务：构造时开启事务，commit()提交，未提交即离开作用域则自动回滚
+    // 同一线程内可嵌套（内层使用保存点），事务内的写操作不再单独提交
+    class TransactionGuard
+    {
+    public:
+        TransactionGuard();
+        ~TransactionGuard();
+        bool isActive() const;
+        bool commit();
+        void rollback();
+        static bool inTransaction(); // 当前线程是否处于显式事务中
+        // 事务内产生的变更暂存到最外层提交后再应用到内存仓库并发出，回滚时随之丢弃
+        static void deferChanges(const QList<TaskChange>& changes);
+
+    private:
+        TransactionGuard(const TransactionGuard&) = delete;
+        TransactionGuard& operator=(const TransactionGuard&) = delete;
+
+        ConnectionPool::Lease m_lease; // 事务期间持有写租约
+        int m_depth; // 嵌套层级（0为最外层）
+        int m_pendingMark; // 本层开始时暂存变更的数量（回滚到保存点时截断到此处）
+        bool m_active;
+        static thread_local int s_depth;
+        static thread_local QList<TaskChange> s_pendingChanges;
+    };
+
     // 单例模式：全局唯一实例
     static DatabaseManager& instance() {
         static DatabaseManager instance;
         return instance;
     }
 
-    // 初始化数据库（创建表、新增字段）
+    // 初始化数据库（创建表、新增字段）；已初始化时直接返回true，不重复装载内存仓库
     bool init();
     // 关闭数据库连接
     void close();
-    // 获取线程安全数据库连接（多线程操作必备）
-    QSqlDatabase getThreadSafeDatabase();
+    // 立即关闭当前线程的连接池连接（工作线程结束前调用；线程退出时也会自动关闭）
+    void releaseThreadConnection();
+    // 改用指定的数据库文件（须在init()前调用，供测试使用临时数据库）
+    void setDatabasePath(const QString& dbPath);
+    // 持久性配置：可在init()前设置，运行中修改会应用到主连接并在各池连接下次签出时生效
+    void setDurabilityProfile(const DurabilityProfile& profile);
+    DurabilityProfile durabilityProfile();
 
     // 原有核心任务操作方法
-    bool addTask(const Task& task);
+    bool addTask(const Task& task, int* insertedId = nullptr); // insertedId：可选，返回新任务ID
     bool updateTask(const Task& task);
     bool deleteTask(int taskId);
+    // 批量新增：全部任务在一个事务中写入并只提交一次，任一失败则整体不生效
+    bool addTasks(const QList<Task>& tasks, QList<int>* insertedIds = nullptr);
     QList<Task> getAllTasks(); // 仅返回未归档任务
 
     // 归档相关方法
@@ -52,19 +117,58 @@ public:
     bool deleteTaskPermanently(int taskId); // 永久删除归档任务（不可恢复）
 
     // 标签相关方法
-    bool addTagsForTask(int taskId, const QStringList& tagNames); // 给任务添加标签（先删旧标签再新增）
+    bool addTagsForTask(int taskId, const QStringList& tagNames); // 替换任务的标签（先删旧标签再新增，空列表即清除全部标签）
     QStringList getTagsForTask(int taskId); // 获取指定任务的所有标签
+    QHash<int, QStringList> getTagsForAllTasks(); // 一次分组查询批量获取所有任务的标签（任务ID -> 标签列表）
+    QHash<int, QStringList> getTagsForTasks(const QVector<int>& taskIds); // 一条查询获取一组任务的标签（表格按页加载时使用）
     QStringList getAllDistinctTags(); // 获取系统中所有不重复的标签
     QList<Task> getTasksByTag(const QString& tagName); // 根据标签筛选未归档任务
 
     // 补充缺失的方法（完整新增）
     QList<Task> getOverdueUncompletedTasks(); // 获取所有逾期未完成的未归档任务
+    QList<Task> getUpcomingTasks(int withinMinutes); // 获取指定分钟内即将到期的未完成未归档任务
+    QList<Task> getTasksDueBetween(const QDateTime& start, const QDateTime& end); // 获取截止时间在区间内的未归档任务
     int getTotalTaskCount(); // 获取未归档任务总数
     int getCompletedTaskCount(); // 获取未归档的已完成任务数
     int getOverdueUncompletedCount(); // 获取逾期未完成的任务数（快捷方法）
+    // 不早于fromMs的最近一个未完成未归档任务的截止时间（毫秒，没有时返回-1），只读索引中的一项
+    qint64 nextUncompletedDueTime(qint64 fromMs);
     double getCompletionRate(); // 计算未归档任务的完成率（百分比，保留1位小数）
+    // 一次查询得到全部统计：与时间无关的计数来自触发器维护的task_counters，逾期数在截止时间索引上计数
+    TaskStats getTaskStats();
     Task getTaskById(int taskId);
 
+    // 提醒记录（持久化的"已提醒"状态，重启后不重复提醒）：每个任务每种提醒保留一行，
+    // 记录提醒所针对的时间（逾期、即将到期为截止时间，自定义提醒为提醒时间），该时间改变后视为未提醒
+    enum AlertKind { AlertOverdue = 0, AlertUpcoming = 1, AlertReminder = 2, AlertKindCount };
+    QHash<int, qint64> getAlertLog(AlertKind kind); // 任务ID -> 已提醒的时间（毫秒）
+    bool recordAlerts(AlertKind kind, const QList<QPair<int, qint64>>& alerts); // (任务ID, 提醒针对的时间)
+    QList<Task> queryTasks(const TaskQuery& query); // 按组合条件筛选任务（条件下推为一条参数化SQL）
+    // 全文检索未归档任务（标题、备注、标签，语义见TaskQuery::searchTerms()），按相关度排序；
+    // withSnippets为true时附带高亮片段
+    QList<TaskSearchHit> searchTasks(const QString& text, int limit = 0, bool withSnippets = false); // limit<=0为不限制
+
+    // 流式读取：逐行交给visitor处理，visitor返回false时提前结束，不构造完整的任务列表
+    // 返回值表示查询是否成功执行（提前结束不算失败）；查询期间持有读租约，visitor内不要再次发起同一查询
+    typedef std::function<bool(const Task&)> TaskVisitor;
+    typedef std::function<bool(const TaskVisitor&)> TaskSource; // 行数据源：依次把每一行交给visitor
+    enum TaskScope { ActiveTasks, ArchivedTasks };
+    bool forEachTask(TaskScope scope, const TaskVisitor& visitor); // 遍历内存快照（ID倒序）
+    bool forEachTaskByTag(const QString& tagName, const TaskVisitor& visitor);
+    bool forEachTask(const TaskQuery& query, const TaskVisitor& visitor); // 按组合条件在数据库端筛选
+    bool forEachOverdueUncompletedTask(const TaskVisitor& visitor);
+    bool forEachUpcomingTask(int withinMinutes, const TaskVisitor& visitor);
+    bool forEachTaskDueBetween(const QDateTime& start, const QDateTime& end, const TaskVisitor& visitor);
+    // 截止时间在区间内的未完成未归档任务（只扫描索引上status = 0的一段）
+    bool forEachUncompletedTaskDueBetween(const QDateTime& start, const QDateTime& end, const TaskVisitor& visitor);
+
+    // 内存任务仓库：读操作直接由内存快照提供，数据库仅承担写入
+    TaskSnapshotPtr taskSnapshot(); // 获取当前版本的任务快照
+    TaskColumnsPtr activeTaskColumns(); // 未归档任务的列式数据（按截止时间升序，供报表聚合）
+    quint64 dataVersion(); // 当前数据版本号（任何写入后递增）
+    // 行级变更通知：每次写入提交成功后发出tasksChanged（显式事务内的写入在最外层提交后发出）
+    TaskChangeNotifier* changeNotifier();
+
 private:
     // 私有构造函数/析构函数（单例模式，禁止外部实例化）
     DatabaseManager();
@@ -73,10 +177,122 @@ private:
     DatabaseManager(const DatabaseManager&) = delete;
     DatabaseManager& operator=(const DatabaseManager&) = delete;
 
-    QSqlDatabase m_db; // 主数据库连接
-    QMutex m_mutex; // 线程安全锁（保护数据库连接创建）
+    QSqlDatabase m_db; // 主数据库连接（初始化与表结构迁移）
+    QMutex m_mutex; // 线程安全锁（保护持久性配置）
+    DurabilityProfile m_durability; // 当前持久性配置
+    ConnectionPool m_pool; // 读写连接池（读写操作均从池中签出连接）
     QString m_connectionName; // 主连接名称
     QString m_dbPath; // 固定数据库文件路径
+    TaskStore m_store; // 内存任务仓库（写穿透）
+    TaskChangeNotifier m_changeNotifier; // 变更通知（随写入同步内存仓库后发出）
+    bool m_fullTextSearch = false; // task_search全文索引是否可用（init()时探测FTS5）
+
+    // 把已提交的变更应用到内存仓库后发出通知（调用方持有写租约，保证与提交顺序一致）
+    void publishChanges(QList<TaskChange> changes);
+
+    // 预编译语句编号：每个编号对应statementSql()中的一条固定SQL
+    enum StatementId {
+        StmtInsertTask,
+        StmtUpdateTask,
+        StmtDeleteTask,
+        StmtArchiveCompleted,
+        StmtSelectCompletedActiveIds,
+        StmtRestoreTask,
+        StmtDeleteTaskTags,
+        StmtInternTag,
+        StmtAddTaskTag,
+        StmtSelectTaskTags,
+        StmtSelectAllTaskTags,
+        StmtSelectDistinctTags,
+        StmtSelectTasksByTag,
+        StmtSelectDueRange,
+        StmtSelectUncompletedDueRange,
+        StmtCountOverdue,
+        StmtNextUncompletedDue,
+        StmtSelectTaskStats,
+        StmtSelectAlertLog,
+        StmtRecordAlert,
+        StmtInsertSearchText,
+        StmtUpdateSearchText,
+        StmtUpdateSearchTags,
+        StmtDeleteSearchText,
+        StmtCount
+    };
+    static QString statementSql(StatementId id);
+
+    // 预编译语句缓存（随连接池连接保存）：同一语句只解析和规划一次，之后重新绑定参数即可执行
+    // 离开作用域时finish()重置语句，释放读游标但保留编译结果
+    class CachedStatement
+    {
+    public:
+        CachedStatement(QSqlDatabase& db, StatementId id);
+        CachedStatement(QSqlDatabase& db, const QString& sql); // 组合查询按SQL文本缓存
+        ~CachedStatement();
+        QSqlQuery* operator->() { return m_query; }
+        QSqlQuery& operator*() { return *m_query; }
+
+    private:
+        CachedStatement(const CachedStatement&) = delete;
+        CachedStatement& operator=(const CachedStatement&) = delete;
+        static QSharedPointer<QSqlQuery> prepare(QSqlDatabase& db, const QString& sql, bool* prepared);
+
+        QSqlQuery* m_query;
+        QSharedPointer<QSqlQuery> m_fallback; // 未进入缓存的语句（非池连接或预编译失败）
+    };
+
+    // 组提交：多个线程的并发写请求合并到同一事务中一次提交
+    typedef std::function<bool(QSqlDatabase&)> WriteWork;
+    struct WriteRequest {
+        const WriteWork* work = nullptr;
+        QList<TaskChange>* changes = nullptr; // work产生的行级变更，提交成功后应用
+        bool done = false;
+        bool success = false;
+    };
+    QMutex m_writeMutex; // 保护写请求队列
+    QWaitCondition m_writeFinished; // 一批写请求提交完成
+    QList<WriteRequest*> m_pendingWrites; // 等待提交的写请求
+    bool m_writeLeaderActive = false; // 是否已有线程在执行提交
+
+    // 执行一次写操作：显式事务内直接执行（变更暂存到事务提交），否则进入组提交队列，
+    // 提交成功后由执行提交的线程把changes应用到内存仓库并发出通知
+    bool executeWrite(const WriteWork& work, QList<TaskChange>* changes = nullptr);
+    void commitWriteBatch(const QList<WriteRequest*>& batch);
+    static void bindTaskValues(QSqlQuery& query, const Task& task);
+    bool deleteTaskRow(QSqlDatabase& db, int taskId);
+    // 同步task_search中的一行（全文索引不可用时直接返回true）
+    bool writeSearchText(QSqlDatabase& db, StatementId id, int taskId, const QVariantMap& values);
+
+    // 在指定连接上应用连接级PRAGMA（调用方需持有m_mutex）
+    void applyConnectionPragmas(QSqlDatabase& db);
+
+    // 版本化表结构迁移（基于PRAGMA user_version）
+    bool migrateSchema();
+    bool migrateToV1(QSqlQuery& query); // 基础表结构，兼容旧版数据库的字段补齐
+    bool migrateToV2(QSqlQuery& query); // 标签字典化：tag + task_tag
+    bool migrateToV3(QSqlQuery& query); // 时间字段改为毫秒时间戳 + 截止时间复合索引
+    bool migrateToV4(QSqlQuery& query); // 全文索引task_search（不支持FTS5时只留下过期标记）
+    bool migrateToV5(QSqlQuery& query); // 触发器维护的分组计数表task_counters
+    bool migrateToV6(QSqlQuery& query); // 提醒记录表task_alert_log
+
+    // 探测当前SQLite是否支持FTS5
+    bool probeFullTextSearch(QSqlQuery& query);
+    // 建立（或重建）task_search并由应用分词写入全部任务，清除过期标记（在调用方的事务中执行）
+    bool buildSearchIndex(QSqlQuery& query);
+    // 启动时探测FTS5；索引带过期标记时重建。不支持FTS5时改用LIKE，不影响启动
+    void prepareSearchIndex();
+
+    // 从数据库全量装载内存任务仓库
+    bool loadTaskStore();
+    // 统一的任务查询列与行解析
+    static QString taskColumns(const QString& alias = QString());
+    static Task taskFromQuery(const QSqlQuery& query);
+    // 时间字段以毫秒时间戳存储，读取时无需字符串解析
+    static QVariant toEpochMs(const QDateTime& dateTime);
+    static QDateTime fromEpochMs(const QVariant& value);
+    // 基于(is_archived, status, due_time)索引的截止时间范围查询（闭区间），逐行回调
+    bool forEachTaskInDueRange(qint64 fromMs, qint64 toMs, bool uncompletedOnly, const TaskVisitor& visitor);
+    // 逐行数据源收集为列表（供返回QList的旧接口使用）
+    static QList<Task> collectTasks(const TaskSource& source);
 };
 
 #endif // DATABASEMANAGER_H
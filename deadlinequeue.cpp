@@ -0,0 +1,102 @@
+#include "deadlinequeue.h"
+#include <QDateTime>
+#include <QTimer>
+#include <algorithm>
+#include <functional>
+
+namespace {
+// 小顶堆比较：时间早的在堆顶
+const std::greater<QPair<qint64, int>> kEntryOrder = std::greater<QPair<qint64, int>>();
+const qint64 kMaxTimerWaitMs = 60 * 60 * 1000;
+}
+
+void DeadlineQueue::schedule(int taskId, qint64 atMs)
+{
+    m_pending.insert(taskId, atMs);
+    m_heap.append(qMakePair(atMs, taskId));
+    std::push_heap(m_heap.begin(), m_heap.end(), kEntryOrder);
+    compact();
+}
+
+bool DeadlineQueue::cancel(int taskId)
+{
+    return m_pending.remove(taskId) > 0;
+}
+
+void DeadlineQueue::clear()
+{
+    m_heap.clear();
+    m_pending.clear();
+}
+
+bool DeadlineQueue::contains(int taskId) const
+{
+    return m_pending.contains(taskId);
+}
+
+int DeadlineQueue::count() const
+{
+    return m_pending.count();
+}
+
+void DeadlineQueue::compact()
+{
+    if (m_heap.count() <= 2 * m_pending.count() + 1024) return;
+    m_heap.clear();
+    m_heap.reserve(m_pending.count());
+    for (QHash<int, qint64>::const_iterator it = m_pending.constBegin(); it != m_pending.constEnd(); ++it) {
+        m_heap.append(qMakePair(it.value(), it.key()));
+    }
+    std::make_heap(m_heap.begin(), m_heap.end(), kEntryOrder);
+}
+
+void DeadlineQueue::dropStaleTop()
+{
+    while (!m_heap.isEmpty()) {
+        const Entry& top = m_heap.first();
+        QHash<int, qint64>::const_iterator pending = m_pending.constFind(top.second);
+        if (pending != m_pending.constEnd() && pending.value() == top.first) return;
+        std::pop_heap(m_heap.begin(), m_heap.end(), kEntryOrder);
+        m_heap.removeLast();
+    }
+}
+
+qint64 DeadlineQueue::nextDeadline()
+{
+    dropStaleTop();
+    return m_heap.isEmpty() ? -1 : m_heap.first().first;
+}
+
+QVector<int> DeadlineQueue::takeUntil(qint64 limitMs)
+{
+    QVector<int> taskIds;
+    while (!m_heap.isEmpty() && m_heap.first().first <= limitMs) {
+        const Entry entry = m_heap.first();
+        std::pop_heap(m_heap.begin(), m_heap.end(), kEntryOrder);
+        m_heap.removeLast();
+
+        QHash<int, qint64>::iterator pending = m_pending.find(entry.second);
+        if (pending == m_pending.end() || pending.value() != entry.first) continue; // 已取消或已改期
+        m_pending.erase(pending);
+        taskIds.append(entry.second);
+    }
+    return taskIds;
+}
+
+QTimer* DeadlineQueue::createTimer(QObject* parent)
+{
+    QTimer* timer = new QTimer(parent);
+    timer->setSingleShot(true);
+    timer->setTimerType(Qt::PreciseTimer);
+    return timer;
+}
+
+void DeadlineQueue::armTimer(QTimer* timer, qint64 deadlineMs)
+{
+    if (deadlineMs < 0) {
+        timer->stop();
+        return;
+    }
+    const qint64 waitMs = deadlineMs - QDateTime::currentMSecsSinceEpoch();
+    timer->start(int(qBound<qint64>(0, waitMs, kMaxTimerWaitMs)));
+}
@@ -0,0 +1,45 @@
+#ifndef DEADLINEQUEUE_H
+#define DEADLINEQUEUE_H
+
+#include <QHash>
+#include <QPair>
+#include <QVector>
+
+class QObject;
+class QTimer;
+
+// 按任务ID去重的截止时间小顶堆：每个任务只保留最后一次安排的时间
+// 改期与取消不删除堆中旧条目，出堆时与m_pending核对后丢弃；作废条目过多时按有效条目重建堆
+class DeadlineQueue
+{
+public:
+    DeadlineQueue() = default;
+
+    void schedule(int taskId, qint64 atMs); // 安排或改期（毫秒时间戳）
+    bool cancel(int taskId); // 返回该任务原先是否已安排
+    void clear();
+    bool contains(int taskId) const;
+    int count() const; // 有效条目数
+
+    // 最近的有效时间（没有时返回-1）
+    qint64 nextDeadline();
+    // 取出时间不晚于limitMs的全部有效条目（按时间先后）
+    QVector<int> takeUntil(qint64 limitMs);
+
+    // 供到点检查使用的单次精确定时器
+    static QTimer* createTimer(QObject* parent);
+    // 安排定时器在deadlineMs触发（<0时停止）。时间很远时分段等待，避免系统休眠或调整时钟后
+    // 长时间不触发：最长等待1小时，到时由调用方重新检查并再次安排
+    static void armTimer(QTimer* timer, qint64 deadlineMs);
+
+private:
+    typedef QPair<qint64, int> Entry; // 时间 -> 任务ID
+
+    void dropStaleTop(); // 丢弃堆顶已作废的条目
+    void compact();
+
+    QVector<Entry> m_heap;
+    QHash<int, qint64> m_pending; // 任务ID -> 当前有效的时间
+};
+
+#endif // DEADLINEQUEUE_H
@@ -0,0 +1,66 @@
+#include "livesearchworker.h"
+#include <QDebug>
+
+namespace {
+// 每批发送的结果数：首批尽快上屏，之后批量追加减少界面刷新次数
+const int kFirstChunkSize = 50;
+const int kChunkSize = 500;
+}
+
+LiveSearchWorker::LiveSearchWorker(QObject *parent)
+    : QObject(parent)
+    , m_generation(0)
+{
+    // 接收方为本对象：移入工作线程后变更通知按队列连接在工作线程处理
+    connect(DatabaseManager::instance().changeNotifier(), &TaskChangeNotifier::tasksChanged,
+            this, &LiveSearchWorker::applyChanges);
+}
+
+int LiveSearchWorker::nextGeneration()
+{
+    return m_generation.fetchAndAddOrdered(1) + 1;
+}
+
+bool LiveSearchWorker::isCurrent(int generation) const
+{
+    return m_generation.loadAcquire() == generation;
+}
+
+void LiveSearchWorker::search(int generation, const QString& text)
+{
+    // 排队期间已有更新的输入：直接放弃
+    if (!isCurrent(generation)) return;
+
+    // 首次检索时全量构建，之后只由变更通知逐个任务更新
+    // 构建后才到达的通知可能包含构建时已读到的变更，重复应用结果不变
+    // 任务内容从内存仓库的快照读取，索引中只有任务ID
+    DatabaseManager& db = DatabaseManager::instance();
+    const TaskSnapshotPtr snapshot = db.taskSnapshot();
+    if (!m_searchIndex.isBuilt()) {
+        m_searchIndex.build(snapshot->activeTasks, db.getTagsForAllTasks());
+    }
+
+    QList<Task> chunk;
+    int chunkSize = kFirstChunkSize;
+    bool completed = m_searchIndex.forEachMatch(text, *snapshot, [&](const Task& task) -> bool {
+        chunk.append(task);
+        if (chunk.count() < chunkSize) return true;
+        // 每批发送前检查是否过期，过期则中止本次检索
+        if (!isCurrent(generation)) return false;
+        emit resultsReady(generation, chunk, false);
+        chunk.clear();
+        chunkSize = kChunkSize;
+        return true;
+    });
+
+    if (completed && isCurrent(generation)) {
+        emit resultsReady(generation, chunk, true);
+    } else {
+        qDebug() << "实时搜索已取消（输入已更新）：" << text;
+    }
+}
+
+void LiveSearchWorker::applyChanges(const QList<TaskChange>& changes)
+{
+    m_searchIndex.applyChanges(changes);
+}
@@ -0,0 +1,37 @@
+#ifndef LIVESEARCHWORKER_H
+#define LIVESEARCHWORKER_H
+
+#include <QObject>
+#include <QList>
+#include <QAtomicInt>
+#include "databasemanager.h"
+#include "tasksearchindex.h"
+
+// 边输入边搜索工作类（Worker + moveToThread模式）
+// 每次检索带一个递增的代号：新代号到达后，旧检索在下一个检查点放弃，结果分批发出
+class LiveSearchWorker : public QObject
+{
+    Q_OBJECT
+public:
+    explicit LiveSearchWorker(QObject *parent = nullptr);
+
+    // 登记新的检索代号（可在任意线程调用），之前的检索随即视为过期
+    int nextGeneration();
+    bool isCurrent(int generation) const;
+
+signals:
+    // 一批检索结果（finished为true表示本次检索已结束，此时tasks可能为空）
+    void resultsReady(int generation, const QList<Task>& tasks, bool finished);
+
+public slots:
+    void search(int generation, const QString& text);
+
+private slots:
+    void applyChanges(const QList<TaskChange>& changes); // 按行级变更更新检索索引
+
+private:
+    QAtomicInt m_generation; // 最新检索代号
+    TaskSearchIndex m_searchIndex; // 仅在工作线程内访问，首次检索时构建
+};
+
+#endif // LIVESEARCHWORKER_H
@@ -9,7 +9,8 @@ int main(int argc, char *argv[])
 {
     QApplication a(argc, argv);
 
-    // 初始化数据库
+    // 初始化数据库（WAL + NORMAL：提醒线程读取与界面线程写入互不阻塞）
+    DatabaseManager::instance().setDurabilityProfile(DurabilityProfile::balanced());
     if (!DatabaseManager::instance().init()) {
         QMessageBox::critical(nullptr, "初始化失败", "数据库初始化失败，程序将退出！");
         return -1;
@@ -22,17 +23,29 @@ int main(int argc, char *argv[])
 
     // 连接线程启动信号与工作对象的开始检查槽
     QObject::connect(reminderThread, &QThread::started, reminderWorker, &ReminderWorker::startChecking);
-
-    // 启动线程
-    reminderThread->start();
+    // 任务变更时唤醒提醒线程（跨线程排队调用），不再定时轮询
+    QObject::connect(DatabaseManager::instance().changeNotifier(), &TaskChangeNotifier::tasksChanged,
+                     reminderWorker, &ReminderWorker::onTasksChanged);
+    // 线程结束前（在该线程内）关闭其连接池连接
+    QObject::connect(reminderThread, &QThread::finished, reminderThread, []() {
+        DatabaseManager::instance().releaseThreadConnection();
+    }, Qt::DirectConnection);
 
     // 创建并显示主窗口
     MainWindow w;
+    // 提醒在提醒线程中检查，成批排队发给界面线程展示
+    QObject::connect(reminderWorker, &ReminderWorker::alertsReady, &w, &MainWindow::onTaskAlerts);
+    // 展示后才写入提醒记录：退出时尚未展示的提醒下次启动重新发出
+    QObject::connect(&w, &MainWindow::taskAlertsShown, reminderWorker, &ReminderWorker::recordShownAlerts);
     w.show();
 
+    // 主窗口连接提醒信号后再启动线程，启动时的首批提醒不会丢失
+    reminderThread->start();
+
     // 应用程序退出时清理线程
     int ret = a.exec();
-    reminderWorker->stop();
+    // 定时器属于提醒线程，须在该线程内停止
+    QMetaObject::invokeMethod(reminderWorker, "stop", Qt::BlockingQueuedConnection);
     reminderThread->quit();
     reminderThread->wait();
     delete reminderWorker;
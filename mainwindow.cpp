@@ -6,6 +6,9 @@
 #include "statisticdialog.h"
 #include "pdfexporter.h"
 #include "csvexporter.h"
+#include "livesearchworker.h"
+#include "notificationcenter.h"
+#include "asyncdatabase.h"
 #include <QMessageBox>
 #include <QDialog>
 #include <QFormLayout>
@@ -23,25 +26,32 @@
 #include <QMap>
 #include <QDebug>
 #include <QSet>
+#include <QThread>
 
 MainWindow::MainWindow(QWidget *parent)
     : QMainWindow(parent)
     , ui(new Ui::MainWindow)
     , m_taskModel(new TaskTableModel(this))
+    , m_notificationCenter(new NotificationCenter(this, this))
     , m_reportDialog(nullptr)
-    , m_globalTaskMonitorTimer(new QTimer(this))
+    , m_searchThread(new QThread(this))
+    , m_searchWorker(new LiveSearchWorker)
+    , m_searchDebounceTimer(new QTimer(this))
+    , m_searchGeneration(0)
+    , m_statsRequest(0)
+    , m_tagFilterRequest(0)
 {
     ui->setupUi(this);
 
-    // 初始化数据库
-    if (!DatabaseManager::instance().init()) {
-        QMessageBox::critical(this, "错误", "数据库初始化失败！");
-        this->close();
-        return;
-    }
+    // 数据库已在main()中初始化（失败时不会创建主窗口）
 
-    // 绑定表格模型
+    // 绑定表格模型（筛选结果或数据变化后更新下拉选项的计数）
     ui->tableViewTasks->setModel(m_taskModel);
+    connect(m_taskModel, &TaskTableModel::facetCountsChanged, this, &MainWindow::updateFilterCounts);
+    // 已完成、归档或删除的任务从提醒面板中移除
+    connect(DatabaseManager::instance().changeNotifier(), &TaskChangeNotifier::tasksChanged,
+            m_notificationCenter, &NotificationCenter::applyTaskChanges);
+    connect(m_notificationCenter, &NotificationCenter::alertsShown, this, &MainWindow::taskAlertsShown);
     // 调整表格的列宽
     QHeaderView* header = ui->tableViewTasks->horizontalHeader();
     header->setSectionResizeMode(QHeaderView::ResizeToContents);
@@ -54,7 +64,6 @@ MainWindow::MainWindow(QWidget *parent)
     initTagFilter();
     m_taskModel->refreshTasks();
     updateStatisticPanel();
-    initTaskReminders();
 
     // 绑定信号槽
     connect(ui->btnAdd, &QPushButton::clicked, this, &MainWindow::onBtnAddClicked);
@@ -64,44 +73,38 @@ MainWindow::MainWindow(QWidget *parent)
     connect(ui->btnExportCsv, &QPushButton::clicked, this, &MainWindow::onBtnExportCsvClicked);
     connect(ui->btnGenerateReport, &QPushButton::clicked, this, &MainWindow::on_btnGenerateReport_clicked);
 
-    connect(ui->comboCategoryFilter, &QComboBox::currentTextChanged, this, &MainWindow::onFilterChanged);
-    connect(ui->comboPriorityFilter, &QComboBox::currentTextChanged, this, &MainWindow::onFilterChanged);
-    connect(ui->comboStatusFilter, &QComboBox::currentTextChanged, this, &MainWindow::onFilterChanged);
-    connect(ui->comboTagFilter, &QComboBox::currentTextChanged, this, &MainWindow::onFilterChanged);
+    // 下拉项文字随计数变化，按选中项而不是文字触发筛选
+    connect(ui->comboCategoryFilter, qOverload<int>(&QComboBox::currentIndexChanged), this, &MainWindow::onFilterChanged);
+    connect(ui->comboPriorityFilter, qOverload<int>(&QComboBox::currentIndexChanged), this, &MainWindow::onFilterChanged);
+    connect(ui->comboStatusFilter, qOverload<int>(&QComboBox::currentIndexChanged), this, &MainWindow::onFilterChanged);
+    connect(ui->comboTagFilter, qOverload<int>(&QComboBox::currentIndexChanged), this, &MainWindow::onFilterChanged);
     connect(ui->btnRefreshFilter, &QPushButton::clicked, this, &MainWindow::onBtnRefreshFilterClicked);
 
     connect(ui->btnArchiveCompleted, &QPushButton::clicked, this, &MainWindow::on_btnArchiveCompleted_clicked);
     connect(ui->btnViewArchive, &QPushButton::clicked, this, &MainWindow::on_btnViewArchive_clicked);
     connect(ui->btnSearch, &QPushButton::clicked, this, &MainWindow::on_btnSearch_clicked);
 
-    // 全局:后台实时监测配置
-    connect(m_globalTaskMonitorTimer, &QTimer::timeout, this, &MainWindow::onGlobalTaskMonitorTriggered);
-    m_globalTaskMonitorTimer->start(30000); // 30秒监测一次
-    onGlobalTaskMonitorTriggered(); // 初始化时立即监测
-    qDebug() << "全局任务后台监测已启动，监测间隔：30秒";
+    // 实时搜索：停止输入250毫秒后才发起检索，检索在后台线程执行
+    m_searchWorker->moveToThread(m_searchThread);
+    m_searchDebounceTimer->setSingleShot(true);
+    m_searchDebounceTimer->setInterval(250);
+    connect(ui->lineEditSearch, &QLineEdit::textChanged, m_searchDebounceTimer, qOverload<>(&QTimer::start));
+    connect(m_searchDebounceTimer, &QTimer::timeout, this, &MainWindow::startLiveSearch);
+    connect(this, &MainWindow::liveSearchRequested, m_searchWorker, &LiveSearchWorker::search);
+    connect(m_searchWorker, &LiveSearchWorker::resultsReady, this, &MainWindow::onLiveSearchResults);
+    connect(m_searchThread, &QThread::finished, m_searchWorker, &QObject::deleteLater);
+    m_searchThread->start();
 }
 
 
 // 2. 析构函数
 MainWindow::~MainWindow()
 {
-    // 销毁单个任务提醒定时器
-    QMap<int, TaskReminder>::iterator it = m_taskReminders.begin();
-    while (it != m_taskReminders.end()) {
-        if (it.value().reminderTimer) {
-            it.value().reminderTimer->stop();
-            delete it.value().reminderTimer;
-        }
-        ++it;
-    }
-    m_taskReminders.clear();
-
-    // 销毁全局监测定时器
-    if (m_globalTaskMonitorTimer) {
-        m_globalTaskMonitorTimer->stop();
-        delete m_globalTaskMonitorTimer;
-        m_globalTaskMonitorTimer = nullptr;
-    }
+    // 停止实时搜索线程（先作废正在执行的检索）
+    m_searchDebounceTimer->stop();
+    m_searchWorker->nextGeneration();
+    m_searchThread->quit();
+    m_searchThread->wait();
 
     // 销毁报表对话框
     if (m_reportDialog) {
@@ -109,6 +112,8 @@ MainWindow::~MainWindow()
         m_reportDialog = nullptr;
     }
 
+    // 等待已排队的数据库任务执行完毕后再关闭数据库
+    AsyncDatabase::instance().shutdown();
     DatabaseManager::instance().close();
     delete ui;
 }
@@ -116,168 +121,79 @@ MainWindow::~MainWindow()
 // 3. 私有函数：initFilterComboBoxes
 void MainWindow::initFilterComboBoxes()
 {
+    // 筛选值存放在UserRole中，显示文字由updateFilterCounts()追加计数
     // 分类筛选
     ui->comboCategoryFilter->clear();
-    ui->comboCategoryFilter->addItem("全部分类");
-    ui->comboCategoryFilter->addItems({"工作", "学习", "生活", "其他"});
+    for (const QString& name : QStringList{"全部分类", "工作", "学习", "生活", "其他"}) {
+        ui->comboCategoryFilter->addItem(name, name);
+    }
 
     // 优先级筛选
     ui->comboPriorityFilter->clear();
-    ui->comboPriorityFilter->addItem("全部优先级");
-    ui->comboPriorityFilter->addItems({"高", "中", "低"});
+    for (const QString& name : QStringList{"全部优先级", "高", "中", "低"}) {
+        ui->comboPriorityFilter->addItem(name, name);
+    }
 
-    // 状态筛选
+    // 状态筛选（顺序与TaskBitmapIndex::StatusFacet一致）
     ui->comboStatusFilter->clear();
-    ui->comboStatusFilter->addItem("全部状态");
-    ui->comboStatusFilter->addItems({"未完成", "已完成", "未完成（已超期）"});
+    for (const QString& name : QStringList{"全部状态", "未完成", "已完成", "未完成（已超期）"}) {
+        ui->comboStatusFilter->addItem(name, name);
+    }
 }
 
 
 // 4. 私有函数：initTagFilter
 void MainWindow::initTagFilter()
 {
-    ui->comboTagFilter->clear();
-    ui->comboTagFilter->addItem("全部标签");
-    ui->comboTagFilter->addItems(DatabaseManager::instance().getAllDistinctTags());
+    // 标签列表在数据库线程读取，结果到达后再重建（只处理最后一次请求的结果）
+    const int request = ++m_tagFilterRequest;
+    AsyncDatabase::whenReady(AsyncDatabase::instance().allDistinctTags(), this, [this, request](const QStringList& tags) {
+        if (request != m_tagFilterRequest) return;
+
+        // 重建列表时保留当前选择，且不触发筛选（否则每次编辑都会整表重新查询）
+        const QString currentTag = ui->comboTagFilter->currentData().toString();
+        ui->comboTagFilter->blockSignals(true);
+        ui->comboTagFilter->clear();
+        ui->comboTagFilter->addItem("全部标签", "全部标签");
+        for (const QString& tag : tags) {
+            ui->comboTagFilter->addItem(tag, tag);
+        }
+        int currentIndex = ui->comboTagFilter->findData(currentTag);
+        ui->comboTagFilter->setCurrentIndex(qMax(0, currentIndex));
+        ui->comboTagFilter->blockSignals(false);
+        updateFilterCounts();
+
+        // 原选中的标签已不存在：回到全部标签并重新筛选
+        if (!currentTag.isEmpty() && currentIndex < 0) {
+            onFilterChanged();
+        }
+    });
 }
 
 
 // 5. 私有函数：updateStatisticPanel
 void MainWindow::updateStatisticPanel()
 {
-    QList<Task> allTasks = DatabaseManager::instance().getAllTasks();
-    int total = allTasks.count();
-    int completed = 0;
-    int overdue = 0;
-
-    for (const Task& task : allTasks) {
-        if (task.status == 1) completed++;
-        if (task.dueTime < QDateTime::currentDateTime() && task.status == 0) overdue++;
-    }
-
-    ui->labelTotal->setText(QString("总任务：%1").arg(total));
-    ui->labelCompleted->setText(QString("已完成：%1").arg(completed));
-    ui->labelOverdue->setText(QString("逾期：%1").arg(overdue));
-}
-
-// 6. 私有函数：initTaskReminders
-void MainWindow::initTaskReminders()
-{
-    QList<Task> allTasks = DatabaseManager::instance().getAllTasks();
-    for (const Task& task : allTasks) {
-        if (task.remindTime.isValid() && task.remindTime > QDateTime::currentDateTime() && task.status == 0) {
-            setTaskReminder(task);
-        }
-    }
-}
-
-
-// 7. 私有函数：setTaskReminder
-void MainWindow::setTaskReminder(const Task &task)
-{
-    if (m_taskReminders.contains(task.id)) {
-        removeTaskReminder(task.id);
-    }
-
-    if (!task.remindTime.isValid() || task.remindTime <= QDateTime::currentDateTime() || task.status != 0) {
-        return;
-    }
-
-    qint64 delayMs = QDateTime::currentDateTime().msecsTo(task.remindTime);
-    if (delayMs <= 0) return;
-
-    QTimer* reminderTimer = new QTimer(this);
-    reminderTimer->setSingleShot(true);
-    reminderTimer->setInterval(delayMs);
-
-    m_taskReminders.insert(task.id, {task.id, reminderTimer, task.title});
-
-    connect(reminderTimer, &QTimer::timeout, this, [=]() {
-        onTaskReminderTriggered(task.id);
+    // 计数表 + 索引计数，不遍历任务；在数据库线程读取，期间显示搜索结果统计时丢弃
+    const int request = ++m_statsRequest;
+    AsyncDatabase::whenReady(AsyncDatabase::instance().taskStats(), this, [this, request](const TaskStats& stats) {
+        if (request != m_statsRequest) return;
+        ui->labelTotal->setText(QString("总任务：%1").arg(stats.total));
+        ui->labelCompleted->setText(QString("已完成：%1").arg(stats.completed));
+        ui->labelOverdue->setText(QString("逾期：%1").arg(stats.overdue));
     });
-
-    reminderTimer->start();
-    qDebug() << "任务[" << task.title << "]提醒已设置";
-}
-
-// 8. 私有函数：removeTaskReminder
-void MainWindow::removeTaskReminder(int taskId)
-{
-    if (!m_taskReminders.contains(taskId)) return;
-
-    TaskReminder &taskReminder = m_taskReminders[taskId];
-    if (taskReminder.reminderTimer) {
-        taskReminder.reminderTimer->stop();
-        delete taskReminder.reminderTimer;
-        taskReminder.reminderTimer = nullptr;
-    }
-
-    m_taskReminders.remove(taskId);
 }
 
-
-// 9. 私有函数：onTaskReminderTriggered
-void MainWindow::onTaskReminderTriggered(int taskId)
+// 6. 槽函数：onTaskAlerts
+void MainWindow::onTaskAlerts(const TaskAlertBatch& batch)
 {
-    if (!m_taskReminders.contains(taskId)) return;
-
-    Task task = DatabaseManager::instance().getTaskById(taskId);
-    if (!task.isValid() || task.status == 1) {
-        removeTaskReminder(taskId);
-        return;
-    }
-
-    QString tipText = QString("【任务自定义提醒】\n任务名称：%1\n分类：%2\n优先级：%3\n截止时间：%4")
-                          .arg(task.title)
-                          .arg(task.category)
-                          .arg(task.priority)
-                          .arg(task.dueTime.toString("yyyy-MM-dd HH:mm:ss"));
-    QMessageBox::information(this, "任务提醒", tipText);
+    // 提醒交给通知中心排队，节流后合并为一次非模态展示（不弹出模态对话框）
+    m_notificationCenter->enqueue(batch);
 
-    removeTaskReminder(taskId);
-}
-
-void MainWindow::onGlobalTaskMonitorTriggered()
-{
-    QList<Task> allTasks = DatabaseManager::instance().getAllTasks();
-    QSet<int> notifiedOverdueTasks;
-    QSet<int> notifiedUpcomingTasks;
-
-    // 监测逾期任务
-    for (const Task& task : allTasks) {
-        if (task.status == 0 && task.dueTime < QDateTime::currentDateTime()) {
-            if (!notifiedOverdueTasks.contains(task.id)) {
-                QString overdueTip = QString("【任务逾期提醒】\n任务名称：%1\n分类：%2\n优先级：%3\n原定截止时间：%4\n当前状态：未完成（已逾期）")
-                                         .arg(task.title)
-                                         .arg(task.category)
-                                         .arg(task.priority)
-                                         .arg(task.dueTime.toString("yyyy-MM-dd HH:mm:ss"));
-                QMessageBox::warning(this, "任务逾期警告", overdueTip);
-                notifiedOverdueTasks.insert(task.id);
-                qDebug() << "监测到逾期任务：" << task.title;
-            }
-        }
-
-        // 监测即将到期任务（30分钟内）
-        qint64 secsToDue = QDateTime::currentDateTime().secsTo(task.dueTime);
-        if (task.status == 0 && task.dueTime > QDateTime::currentDateTime() && secsToDue > 0 && secsToDue <= 1800) {
-            if (!notifiedUpcomingTasks.contains(task.id)) {
-                QString upcomingTip = QString("【任务即将到期提醒】\n任务名称：%1\n分类：%2\n优先级：%3\n截止时间：%4\n剩余时间：约%5分钟")
-                                          .arg(task.title)
-                                          .arg(task.category)
-                                          .arg(task.priority)
-                                          .arg(task.dueTime.toString("yyyy-MM-dd HH:mm:ss"))
-                                          .arg(qRound(secsToDue / 60.0));
-                QMessageBox::information(this, "任务即将到期", upcomingTip);
-                notifiedUpcomingTasks.insert(task.id);
-                qDebug() << "监测到即将到期任务：" << task.title;
-            }
-        }
+    // 逾期数随时间变化：有新逾期任务时刷新统计面板
+    if (!batch.overdue.isEmpty()) {
+        updateStatisticPanel();
     }
-
-    // 刷新UI
-    m_taskModel->refreshTasks();
-    updateStatisticPanel();
 }
 
 
@@ -285,12 +201,9 @@ void MainWindow::onGlobalTaskMonitorTriggered()
 void MainWindow::onBtnAddClicked()
 {
     Task task;
-    if (showTaskDialog(task, false)) {
-        m_taskModel->refreshTasks();
-        updateStatisticPanel();
-        initTagFilter();
-        setTaskReminder(task);
-        emit taskUpdated();
+    QStringList tags;
+    if (showTaskDialog(task, tags, false)) {
+        saveTask(task, tags, false);
     }
 }
 
@@ -305,12 +218,9 @@ void MainWindow::onBtnEditClicked()
     }
 
     Task task = m_taskModel->getTaskAt(index.row());
-    if (showTaskDialog(task, true)) {
-        m_taskModel->refreshTasks();
-        updateStatisticPanel();
-        initTagFilter();
-        setTaskReminder(task);
-        emit taskUpdated();
+    QStringList tags;
+    if (showTaskDialog(task, tags, true)) {
+        saveTask(task, tags, true);
     }
 }
 
@@ -328,28 +238,26 @@ void MainWindow::onBtnDeleteClicked()
                                     QMessageBox::Yes | QMessageBox::No, QMessageBox::No);
     if (ret != QMessageBox::Yes) return;
 
-    if (DatabaseManager::instance().deleteTask(taskId)) {
-        removeTaskReminder(taskId);
-        QMessageBox::information(this, "成功", "任务删除成功！");
-        m_taskModel->refreshTasks();
-        updateStatisticPanel();
-        initTagFilter();
-        emit taskUpdated();
-    } else {
-        QMessageBox::critical(this, "失败", "任务删除失败！");
-    }
+    // 删除完成前禁用删除按钮，防止重复提交
+    ui->btnDelete->setEnabled(false);
+    AsyncDatabase::whenReady(AsyncDatabase::instance().deleteTask(taskId), this, [this](bool success) {
+        ui->btnDelete->setEnabled(true);
+        if (success) {
+            QMessageBox::information(this, "成功", "任务删除成功！");
+            updateStatisticPanel();
+            initTagFilter();
+            emit taskUpdated();
+        } else {
+            QMessageBox::critical(this, "失败", "任务删除失败！");
+        }
+    });
 }
 
 
 // 13. 槽函数： onBtnExportPdfClicked
 void MainWindow::onBtnExportPdfClicked()
 {
-    QList<Task> exportTasks;
-    for (int i = 0; i < m_taskModel->rowCount(); ++i) {
-        exportTasks.append(m_taskModel->getTaskAt(i));
-    }
-
-    if (exportTasks.isEmpty()) {
+    if (m_taskModel->rowCount() == 0) {
         QMessageBox::warning(this, "提示", "当前无任务可导出！");
         return;
     }
@@ -365,20 +273,22 @@ void MainWindow::onBtnExportPdfClicked()
         return;
     }
 
-    PdfExporter::exportToPdf(exportTasks, filePath);
-    QMessageBox::information(this, "成功", QString("PDF报表已成功导出至：\n%1").arg(filePath));
+    // 按点击时的表格内容逐行导出（行数据来自内存仓库，包括尚未分页加载的行）；
+    // 统计信息在数据库线程读取，到达后再生成PDF，期间禁用导出按钮
+    const DatabaseManager::TaskSource source = m_taskModel->taskSource();
+    ui->btnExportPdf->setEnabled(false);
+    AsyncDatabase::whenReady(AsyncDatabase::instance().taskStats(), this, [this, source, filePath](const TaskStats& stats) {
+        ui->btnExportPdf->setEnabled(true);
+        PdfExporter::exportToPdf(source, stats, filePath);
+        QMessageBox::information(this, "成功", QString("PDF报表已成功导出至：\n%1").arg(filePath));
+    });
 }
 
 
 // 14. 槽函数：onBtnExportCsvClicked
 void MainWindow::onBtnExportCsvClicked()
 {
-    QList<Task> exportTasks;
-    for (int i = 0; i < m_taskModel->rowCount(); ++i) {
-        exportTasks.append(m_taskModel->getTaskAt(i));
-    }
-
-    if (exportTasks.isEmpty()) {
+    if (m_taskModel->rowCount() == 0) {
         QMessageBox::warning(this, "提示", "当前无任务可导出！");
         return;
     }
@@ -394,7 +304,8 @@ void MainWindow::onBtnExportCsvClicked()
         return;
     }
 
-    CsvExporter::exportToCsv(exportTasks, filePath);
+    // 按当前表格内容逐行导出（筛选结果从数据库流式读取，包括尚未分页加载的行）
+    CsvExporter::exportToCsv(m_taskModel->taskSource(), filePath);
     QMessageBox::information(this, "成功", QString("CSV报表已成功导出至：\n%1").arg(filePath));
 }
 
@@ -411,11 +322,9 @@ void MainWindow::on_btnGenerateReport_clicked()
         });
 
         connect(m_reportDialog, &StatisticDialog::accepted, this, [=]() {
-            m_taskModel->refreshTasks();
             updateStatisticPanel();
         });
         connect(m_reportDialog, &StatisticDialog::rejected, this, [=]() {
-            m_taskModel->refreshTasks();
             updateStatisticPanel();
         });
     }
@@ -427,16 +336,45 @@ void MainWindow::on_btnGenerateReport_clicked()
 // 16. 槽函数：onFilterChanged
 void MainWindow::onFilterChanged()
 {
-    QString category = ui->comboCategoryFilter->currentText();
-    QString priority = ui->comboPriorityFilter->currentText();
-    QString status = ui->comboStatusFilter->currentText();
-    QString tag = ui->comboTagFilter->currentText();
+    QString category = ui->comboCategoryFilter->currentData().toString();
+    QString priority = ui->comboPriorityFilter->currentData().toString();
+    QString status = ui->comboStatusFilter->currentData().toString();
+    QString tag = ui->comboTagFilter->currentData().toString();
 
     m_taskModel->setFilterConditions(category, priority, status, tag);
     updateStatisticPanel();
 }
 
 
+// 16.1 槽函数：updateFilterCounts
+void MainWindow::updateFilterCounts()
+{
+    // 每个选项显示选中后的结果行数（其余下拉框条件不变）；只改文字，不改变选中项
+    const TaskBitmapIndex::FacetCounts counts = m_taskModel->facetCounts();
+    auto setCount = [](QComboBox* combo, int row, int count) {
+        combo->setItemText(row, QString("%1 (%2)").arg(combo->itemData(row).toString()).arg(count));
+    };
+
+    setCount(ui->comboCategoryFilter, 0, counts.categoryAll);
+    for (int i = 0; i < CategoryCount && i + 1 < ui->comboCategoryFilter->count(); ++i) {
+        setCount(ui->comboCategoryFilter, i + 1, counts.category[i]);
+    }
+    setCount(ui->comboPriorityFilter, 0, counts.priorityAll);
+    for (int i = 0; i < PriorityCount && i + 1 < ui->comboPriorityFilter->count(); ++i) {
+        setCount(ui->comboPriorityFilter, i + 1, counts.priority[i]);
+    }
+    setCount(ui->comboStatusFilter, 0, counts.statusAll);
+    for (int i = 0; i < TaskBitmapIndex::StatusFacetCount && i + 1 < ui->comboStatusFilter->count(); ++i) {
+        setCount(ui->comboStatusFilter, i + 1, counts.status[i]);
+    }
+    setCount(ui->comboTagFilter, 0, counts.tagAll);
+    for (int row = 1; row < ui->comboTagFilter->count(); ++row) {
+        const QString tag = ui->comboTagFilter->itemData(row).toString();
+        setCount(ui->comboTagFilter, row, counts.tags.value(tag));
+    }
+}
+
+
 // 17. 槽函数：onBtnRefreshFilterClicked
 void MainWindow::onBtnRefreshFilterClicked()
 {
@@ -448,35 +386,35 @@ void MainWindow::onBtnRefreshFilterClicked()
 // 18. 槽函数：on_btnArchiveCompleted_clicked-
 void MainWindow::on_btnArchiveCompleted_clicked()
 {
-    QList<Task> allTasks = DatabaseManager::instance().getAllTasks();
-    int completedCount = 0;
-    QList<int> completedIds;
-    for (const Task& task : allTasks) {
-        if (task.status == 1) {
-            completedCount++;
-            completedIds.append(task.id);
+    // 已完成任务数取自统计计数，不加载全部任务；计数读取与归档完成前禁用归档按钮，防止重复提交
+    ui->btnArchiveCompleted->setEnabled(false);
+    AsyncDatabase::whenReady(AsyncDatabase::instance().taskStats(), this, [this](const TaskStats& stats) {
+        const int completedCount = stats.completed;
+        if (completedCount == 0) {
+            ui->btnArchiveCompleted->setEnabled(true);
+            QMessageBox::information(this, "提示", "无已完成任务可归档！");
+            return;
         }
-    }
 
-    if (completedCount == 0) {
-        QMessageBox::information(this, "提示", "无已完成任务可归档！");
-        return;
-    }
-
-    int ret = QMessageBox::question(this, "确认归档", "确定归档所有已完成任务吗？",
-                                    QMessageBox::Yes | QMessageBox::No, QMessageBox::No);
-    if (ret != QMessageBox::Yes) return;
+        int ret = QMessageBox::question(this, "确认归档", "确定归档所有已完成任务吗？",
+                                        QMessageBox::Yes | QMessageBox::No, QMessageBox::No);
+        if (ret != QMessageBox::Yes) {
+            ui->btnArchiveCompleted->setEnabled(true);
+            return;
+        }
 
-    if (DatabaseManager::instance().archiveCompletedTasks()) {
-        for (int id : completedIds) removeTaskReminder(id);
-        QMessageBox::information(this, "成功", QString("已归档%1个任务！").arg(completedCount));
-        m_taskModel->refreshTasks();
-        updateStatisticPanel();
-        initTagFilter();
-        emit taskUpdated();
-    } else {
-        QMessageBox::critical(this, "失败", "归档失败！");
-    }
+        AsyncDatabase::whenReady(AsyncDatabase::instance().archiveCompletedTasks(), this, [this, completedCount](bool success) {
+            ui->btnArchiveCompleted->setEnabled(true);
+            if (success) {
+                QMessageBox::information(this, "成功", QString("已归档%1个任务！").arg(completedCount));
+                updateStatisticPanel();
+                initTagFilter();
+                emit taskUpdated();
+            } else {
+                QMessageBox::critical(this, "失败", "归档失败！");
+            }
+        });
+    });
 }
 
 
@@ -485,7 +423,6 @@ void MainWindow::on_btnViewArchive_clicked()
 {
     ArchiveDialog* dialog = new ArchiveDialog(this);
     connect(dialog, &ArchiveDialog::accepted, this, [=]() {
-        m_taskModel->refreshTasks();
         updateStatisticPanel();
         initTagFilter();
         emit taskUpdated();
@@ -497,6 +434,10 @@ void MainWindow::on_btnViewArchive_clicked()
 // 20. 槽函数：on_btnSearch_clicked
 void MainWindow::on_btnSearch_clicked()
 {
+    // 完整检索优先：作废尚未完成的实时搜索
+    m_searchDebounceTimer->stop();
+    m_searchGeneration = m_searchWorker->nextGeneration();
+
     QString searchText = ui->lineEditSearch->text().trimmed();
     if (searchText.isEmpty()) {
         m_taskModel->refreshTasks();
@@ -505,31 +446,66 @@ void MainWindow::on_btnSearch_clicked()
         return;
     }
 
-    QList<Task> allTasks = DatabaseManager::instance().getAllTasks();
-    QList<Task> searchTasks;
-    for (const Task& task : allTasks) {
-        if (task.title.contains(searchText, Qt::CaseInsensitive)
-            || task.description.contains(searchText, Qt::CaseInsensitive)) {
-            searchTasks.append(task);
+    // 全文索引检索（标题、备注、标签），结果按相关度排序；结果到达前又发起了新检索时丢弃
+    const int generation = m_searchGeneration;
+    AsyncDatabase::whenReady(AsyncDatabase::instance().searchTasks(searchText), this,
+                             [this, generation](const QList<TaskSearchHit>& hits) {
+        if (generation != m_searchGeneration) return;
+        QList<Task> searchTasks;
+        for (const TaskSearchHit& hit : hits) {
+            searchTasks.append(hit.task);
         }
+
+        m_taskModel->setTaskList(searchTasks);
+        TaskStats stats;
+        const qint64 nowMs = QDateTime::currentMSecsSinceEpoch();
+        for (const Task& task : searchTasks) {
+            stats.accumulate(task, nowMs);
+        }
+        ++m_statsRequest; // 作废尚未返回的全局统计
+        ui->labelTotal->setText(QString("搜索结果：%1").arg(stats.total));
+        ui->labelCompleted->setText(QString("已完成：%1").arg(stats.completed));
+        ui->labelOverdue->setText(QString("逾期：%1").arg(stats.overdue));
+    });
+}
+
+// 21. 槽函数：startLiveSearch（输入防抖结束后发起实时搜索）
+void MainWindow::startLiveSearch()
+{
+    // 新代号使正在执行或排队中的旧检索全部作废
+    m_searchGeneration = m_searchWorker->nextGeneration();
+    QString searchText = ui->lineEditSearch->text().trimmed();
+    if (searchText.isEmpty()) {
+        m_taskModel->refreshTasks();
+        updateStatisticPanel();
+        return;
     }
 
-    m_taskModel->setTaskList(searchTasks);
-    int total = searchTasks.count();
-    int completed = 0;
-    int overdue = 0;
-    for (const Task& task : searchTasks) {
-        if (task.status == 1) completed++;
-        if (task.dueTime < QDateTime::currentDateTime() && task.status == 0) overdue++;
+    m_taskModel->setTaskList(QList<Task>());
+    m_searchStats = TaskStats();
+    emit liveSearchRequested(m_searchGeneration, searchText);
+}
+
+// 22. 槽函数：onLiveSearchResults（按批追加实时搜索结果）
+void MainWindow::onLiveSearchResults(int generation, const QList<Task>& tasks, bool finished)
+{
+    Q_UNUSED(finished);
+    if (generation != m_searchGeneration) return; // 过期检索的结果直接丢弃
+
+    m_taskModel->appendTasks(tasks);
+    const qint64 nowMs = QDateTime::currentMSecsSinceEpoch();
+    for (const Task& task : tasks) {
+        m_searchStats.accumulate(task, nowMs);
     }
-    ui->labelTotal->setText(QString("搜索结果：%1").arg(total));
-    ui->labelCompleted->setText(QString("已完成：%1").arg(completed));
-    ui->labelOverdue->setText(QString("逾期：%1").arg(overdue));
+    ++m_statsRequest; // 作废尚未返回的全局统计
+    ui->labelTotal->setText(QString("搜索结果：%1").arg(m_searchStats.total));
+    ui->labelCompleted->setText(QString("已完成：%1").arg(m_searchStats.completed));
+    ui->labelOverdue->setText(QString("逾期：%1").arg(m_searchStats.overdue));
 }
 
 
-// 21. 私有函数：showTaskDialog
-bool MainWindow::showTaskDialog(Task &task, bool isEdit)
+// 23. 私有函数：showTaskDialog
+bool MainWindow::showTaskDialog(Task &task, QStringList &tags, bool isEdit)
 {
     QDialog dialog(this);
     dialog.setWindowTitle(isEdit ? "编辑任务" : "添加任务");
@@ -546,15 +522,13 @@ bool MainWindow::showTaskDialog(Task &task, bool isEdit)
     // 分类
     QComboBox* comboCategory = new QComboBox(&dialog);
     comboCategory->addItems({"工作", "学习", "生活", "其他"});
-    int cateIdx = comboCategory->findText(task.category);
-    if (cateIdx >= 0) comboCategory->setCurrentIndex(cateIdx);
+    comboCategory->setCurrentIndex(task.category); // 下拉项顺序与枚举一致
     layout->addRow("任务分类：", comboCategory);
 
     // 优先级
     QComboBox* comboPriority = new QComboBox(&dialog);
     comboPriority->addItems({"高", "中", "低"});
-    int prioIdx = comboPriority->findText(task.priority);
-    if (prioIdx >= 0) comboPriority->setCurrentIndex(prioIdx);
+    comboPriority->setCurrentIndex(task.priority);
     layout->addRow("优先级：", comboPriority);
 
     // 截止时间
@@ -593,10 +567,6 @@ bool MainWindow::showTaskDialog(Task &task, bool isEdit)
 
     // 标签
     QLineEdit* editTags = new QLineEdit(&dialog);
-    if (isEdit) {
-        QStringList tags = DatabaseManager::instance().getTagsForTask(task.id);
-        editTags->setText(tags.join(","));
-    }
     layout->addRow("标签（逗号分隔）：", editTags);
 
 //按钮
@@ -611,14 +581,27 @@ bool MainWindow::showTaskDialog(Task &task, bool isEdit)
     connect(btnOk, &QPushButton::clicked, &dialog, &QDialog::accept);
     connect(btnCancel, &QPushButton::clicked, &dialog, &QDialog::reject);
 
+    if (isEdit) {
+        // 原有标签在数据库线程读取，到达时用户尚未修改才填入；
+        // 读到之前不能确认，否则空的标签栏会把原有标签全部清除
+        btnOk->setEnabled(false);
+        const int taskId = task.id;
+        AsyncDatabase::whenReady(AsyncDatabase::instance().run(AsyncDatabase::Interactive, AsyncDatabase::Read, [taskId]() {
+            return DatabaseManager::instance().getTagsForTask(taskId);
+        }), editTags, [editTags, btnOk](const QStringList& tags) {
+            if (!editTags->isModified()) editTags->setText(tags.join(","));
+            btnOk->setEnabled(true);
+        });
+    }
+
     if (dialog.exec() == QDialog::Accepted) {
         task.title = editTitle->text().trimmed();
-        task.category = comboCategory->currentText();
-        task.priority = comboPriority->currentText();
+        task.category = static_cast<TaskCategory>(comboCategory->currentIndex());
+        task.priority = static_cast<TaskPriority>(comboPriority->currentIndex());
         task.dueTime = dtDue->dateTime();
         task.remindTime = dtRemind->dateTime();
-        task.status = comboStatus->currentIndex();
-        task.progress = spinProgress->value();
+        task.status = comboStatus->currentIndex() == 1 ? StatusCompleted : StatusUncompleted;
+        task.progress = static_cast<quint8>(spinProgress->value());
         task.description = editDesc->toPlainText().trimmed();
         task.is_archived = 0;
 
@@ -631,21 +614,24 @@ bool MainWindow::showTaskDialog(Task &task, bool isEdit)
             return false;
         }
 
-        bool success = false;
-        if (isEdit) {
-            success = DatabaseManager::instance().updateTask(task);
-        } else {
-            success = DatabaseManager::instance().addTask(task);
-            QList<Task> allTasks = DatabaseManager::instance().getAllTasks();
-            if (!allTasks.isEmpty()) task.id = allTasks.first().id;
-        }
-
-        if (success && task.id != -1) {
-            QStringList tags = editTags->text().split(",", Qt::SkipEmptyParts);
-            DatabaseManager::instance().addTagsForTask(task.id, tags);
-        }
-        return success;
+        tags = editTags->text().split(",", Qt::SkipEmptyParts);
+        return true;
     }
     return false;
 }
 
+// 24. 私有函数：saveTask（在数据库线程中写入，完成后刷新统计与标签）
+void MainWindow::saveTask(const Task &task, const QStringList &tags, bool isEdit)
+{
+    // 表格由提交后的变更通知按行更新
+    AsyncDatabase::whenReady(AsyncDatabase::instance().saveTask(task, tags, isEdit), this, [this](bool success) {
+        if (!success) {
+            QMessageBox::critical(this, "失败", "任务保存失败！");
+            return;
+        }
+        updateStatisticPanel();
+        initTagFilter();
+        emit taskUpdated();
+    });
+}
+
@@ -2,14 +2,18 @@
 #define MAINWINDOW_H
 
 #include <QMainWindow>
-#include <QMap>
 #include <QTimer>
+#include <QList>
+#include "databasemanager.h" // TaskStats成员与信号槽参数QList<Task>需要完整类型
+#include "reminderworker.h" // 槽参数TaskAlertBatch需要完整类型
 
 // 前置声明
-struct Task;
 namespace Ui { class MainWindow; }
 class TaskTableModel;
 class StatisticDialog; // 前置声明统计报表对话框
+class LiveSearchWorker;
+class NotificationCenter;
+class QThread;
 
 class MainWindow : public QMainWindow
 {
@@ -19,8 +23,16 @@ public:
     explicit MainWindow(QWidget *parent = nullptr);
     ~MainWindow();
 
+public slots:
+    // 后台提醒线程发来的一批提醒，交给通知中心排队展示
+    void onTaskAlerts(const TaskAlertBatch& batch);
+
 signals:
     void taskUpdated();
+    // 通知中心已展示的提醒（转发给提醒线程写入提醒记录）
+    void taskAlertsShown(const TaskAlertBatch& batch);
+    // 请求后台执行实时搜索（排队发送到搜索线程）
+    void liveSearchRequested(int generation, const QString& text);
 
 private slots:
     void onBtnAddClicked();
@@ -29,35 +41,35 @@ private slots:
     void onBtnExportPdfClicked();
     void onBtnExportCsvClicked();
     void onFilterChanged();
+    void updateFilterCounts(); // 在各筛选下拉选项后显示任务数
     void onBtnRefreshFilterClicked();
     void on_btnArchiveCompleted_clicked();
     void on_btnViewArchive_clicked();
     void on_btnSearch_clicked();
     void on_btnGenerateReport_clicked();
-    void onGlobalTaskMonitorTriggered();
+    void startLiveSearch();
+    void onLiveSearchResults(int generation, const QList<Task>& tasks, bool finished);
 
 private:
-    // 内部的结构体
-    struct TaskReminder {
-        int taskId;
-        QTimer* reminderTimer;
-        QString taskTitle;
-    };
-
     Ui::MainWindow *ui;
     TaskTableModel *m_taskModel;
-    QMap<int, TaskReminder> m_taskReminders;
+    NotificationCenter* m_notificationCenter; // 非模态提醒面板与托盘通知
     StatisticDialog* m_reportDialog; // 统计报表对话框指针
-    QTimer* m_globalTaskMonitorTimer; // 全局任务监测定时器
+    // 实时搜索：输入防抖后交给后台线程，结果按代号过滤后分批追加到表格
+    QThread* m_searchThread;
+    LiveSearchWorker* m_searchWorker;
+    QTimer* m_searchDebounceTimer;
+    int m_searchGeneration; // 当前有效的检索代号
+    TaskStats m_searchStats; // 当前检索结果的统计（随结果批次累加）
+    // 异步读取的请求序号：只采用最后一次请求的结果
+    int m_statsRequest;
+    int m_tagFilterRequest;
 
     void initFilterComboBoxes();
     void initTagFilter();
     void updateStatisticPanel();
-    void initTaskReminders();
-    void setTaskReminder(const Task &task);
-    void removeTaskReminder(int taskId);
-    void onTaskReminderTriggered(int taskId);
-    bool showTaskDialog(Task &task, bool isEdit);
+    bool showTaskDialog(Task &task, QStringList &tags, bool isEdit); // 用户确认且输入有效时返回true
+    void saveTask(const Task &task, const QStringList &tags, bool isEdit);
 };
 
 #endif // MAINWINDOW_H
@@ -0,0 +1,309 @@
+#include "notificationcenter.h"
+#include <QApplication>
+#include <QDateTime>
+#include <QDebug>
+#include <QDialog>
+#include <QHBoxLayout>
+#include <QHeaderView>
+#include <QLabel>
+#include <QPushButton>
+#include <QStyle>
+#include <QSystemTrayIcon>
+#include <QTreeWidget>
+#include <QVBoxLayout>
+
+namespace {
+// 首批提醒到达后稍等片刻再展示，把同一时刻的多批合并为一次
+const qint64 kCoalesceMs = 300;
+// 两次展示之间的最小间隔，期间到达的提醒排队后一并展示
+const qint64 kMinIntervalMs = 10 * 1000;
+// 每个分组最多保留的行数（超出时移除最早的行）
+const int kMaxItemsPerGroup = 500;
+// 托盘气泡中列出的任务数
+const int kMaxListedInToast = 3;
+
+const char* const kGroupNames[DatabaseManager::AlertKindCount] = { "已逾期", "即将到期", "自定义提醒" };
+
+// 提醒所针对的时间（毫秒）：逾期与即将到期为截止时间，自定义提醒为提醒时间；无效时为-1
+qint64 alertTimeMs(int kind, const Task& task)
+{
+    const QDateTime& at = kind == DatabaseManager::AlertReminder ? task.remindTime : task.dueTime;
+    return at.isValid() ? at.toMSecsSinceEpoch() : -1;
+}
+}
+
+NotificationCenter::NotificationCenter(QWidget *window, QObject *parent)
+    : QObject(parent)
+    , m_window(window)
+    , m_flushTimer(new QTimer(this))
+    , m_trayIcon(nullptr)
+    , m_panel(nullptr)
+    , m_panelSummary(nullptr)
+    , m_panelTree(nullptr)
+    , m_lastFlushMs(0)
+{
+    for (int kind = 0; kind < DatabaseManager::AlertKindCount; ++kind) {
+        m_groups[kind] = nullptr;
+    }
+
+    m_flushTimer->setSingleShot(true);
+    connect(m_flushTimer, &QTimer::timeout, this, &NotificationCenter::flush);
+
+    if (QSystemTrayIcon::isSystemTrayAvailable()) {
+        QIcon icon = m_window ? m_window->windowIcon() : QIcon();
+        if (icon.isNull()) {
+            icon = QApplication::style()->standardIcon(QStyle::SP_MessageBoxInformation);
+        }
+        m_trayIcon = new QSystemTrayIcon(icon, this);
+        m_trayIcon->setToolTip("任务提醒");
+        connect(m_trayIcon, &QSystemTrayIcon::messageClicked, this, &NotificationCenter::showPanel);
+        connect(m_trayIcon, &QSystemTrayIcon::activated, this, [this](QSystemTrayIcon::ActivationReason reason) {
+            if (reason == QSystemTrayIcon::Trigger || reason == QSystemTrayIcon::DoubleClick) {
+                showPanel();
+            }
+        });
+        m_trayIcon->show();
+    } else {
+        qDebug() << "系统托盘不可用，提醒将直接显示在通知面板中";
+    }
+}
+
+void NotificationCenter::enqueue(const TaskAlertBatch& batch)
+{
+    const QList<Task>* lists[DatabaseManager::AlertKindCount] = { &batch.overdue, &batch.upcoming, &batch.reminders };
+    for (int kind = 0; kind < DatabaseManager::AlertKindCount; ++kind) {
+        for (const Task& task : *lists[kind]) {
+            // 同一任务同种提醒在队列中只保留一条，内容以最新的为准
+            QHash<int, int>::const_iterator queued = m_queued[kind].constFind(task.id);
+            if (queued != m_queued[kind].constEnd()) {
+                m_queue[queued.value()].task = task;
+                continue;
+            }
+            Alert alert;
+            alert.kind = kind;
+            alert.task = task;
+            m_queued[kind].insert(task.id, m_queue.count());
+            m_queue.append(alert);
+        }
+    }
+
+    if (m_queue.isEmpty() || m_flushTimer->isActive()) return;
+    const qint64 nowMs = QDateTime::currentMSecsSinceEpoch();
+    const qint64 delayMs = qMax(kCoalesceMs, m_lastFlushMs + kMinIntervalMs - nowMs);
+    m_flushTimer->start(int(qMin(delayMs, kMinIntervalMs)));
+}
+
+int NotificationCenter::pendingCount() const
+{
+    int count = 0;
+    for (int kind = 0; kind < DatabaseManager::AlertKindCount; ++kind) {
+        count += m_queued[kind].count();
+    }
+    return count;
+}
+
+void NotificationCenter::flush()
+{
+    m_lastFlushMs = QDateTime::currentMSecsSinceEpoch();
+    QList<Alert> alerts;
+    alerts.reserve(m_queue.count());
+    for (const Alert& alert : m_queue) {
+        if (alert.task.isValid()) alerts.append(alert); // 排队期间已完成或删除的任务已作废
+    }
+    m_queue.clear();
+    for (int kind = 0; kind < DatabaseManager::AlertKindCount; ++kind) {
+        m_queued[kind].clear();
+    }
+    if (alerts.isEmpty()) return;
+
+    buildPanel();
+    m_panelTree->setUpdatesEnabled(false);
+    for (const Alert& alert : alerts) {
+        addToPanel(alert);
+    }
+    updateGroupTitles();
+    m_panelTree->setUpdatesEnabled(true);
+
+    const QString summary = summaryText(alerts);
+    m_panelSummary->setText(QString("%1 更新：%2")
+                                .arg(QDateTime::fromMSecsSinceEpoch(m_lastFlushMs).toString("HH:mm:ss"))
+                                .arg(summary));
+    qDebug() << "展示提醒：" << alerts.count() << "条";
+
+    if (m_trayIcon && QSystemTrayIcon::supportsMessages()) {
+        bool hasOverdue = false;
+        QString message = summary;
+        for (int i = 0; i < alerts.count() && i < kMaxListedInToast; ++i) {
+            message += QString("\n· %1").arg(alerts.at(i).task.title);
+        }
+        for (const Alert& alert : alerts) {
+            if (alert.kind == DatabaseManager::AlertOverdue) hasOverdue = true;
+        }
+        m_trayIcon->showMessage("任务提醒", message,
+                                hasOverdue ? QSystemTrayIcon::Warning : QSystemTrayIcon::Information, 10000);
+    } else if (!m_panel->isVisible()) {
+        // 不抢占当前窗口的焦点
+        m_panel->setAttribute(Qt::WA_ShowWithoutActivating);
+        m_panel->show();
+    }
+
+    // 已展示的提醒才写入提醒记录
+    TaskAlertBatch shown;
+    QList<Task>* lists[DatabaseManager::AlertKindCount] = { &shown.overdue, &shown.upcoming, &shown.reminders };
+    for (const Alert& alert : alerts) {
+        lists[alert.kind]->append(alert.task);
+    }
+    emit alertsShown(shown);
+}
+
+void NotificationCenter::showPanel()
+{
+    buildPanel();
+    m_panel->setAttribute(Qt::WA_ShowWithoutActivating, false);
+    m_panel->show();
+    m_panel->raise();
+    m_panel->activateWindow();
+}
+
+void NotificationCenter::clearPanel()
+{
+    if (!m_panel) return;
+    for (int kind = 0; kind < DatabaseManager::AlertKindCount; ++kind) {
+        qDeleteAll(m_groups[kind]->takeChildren());
+        m_items[kind].clear();
+    }
+    updateGroupTitles();
+    m_panelSummary->setText("暂无提醒");
+}
+
+void NotificationCenter::applyTaskChanges(const QList<TaskChange>& changes)
+{
+    bool removed = false;
+    for (const TaskChange& change : changes) {
+        bool stillPending = false;
+        switch (change.type) {
+        case TaskChange::Deleted:
+        case TaskChange::Archived:
+            break;
+        case TaskChange::Inserted:
+        case TaskChange::Updated:
+        case TaskChange::Restored:
+            stillPending = change.task.isValid() && !change.task.is_archived
+                           && change.task.status == StatusUncompleted;
+            break;
+        case TaskChange::TagsChanged:
+            continue;
+        }
+
+        for (int kind = 0; kind < DatabaseManager::AlertKindCount; ++kind) {
+            // 截止时间或提醒时间改动后原提醒作废（如逾期任务改到将来）；新时间若仍需提醒，由提醒线程重新发出
+            const qint64 atMs = alertTimeMs(kind, change.task);
+            QHash<int, int>::iterator queued = m_queued[kind].find(change.taskId);
+            if (queued != m_queued[kind].end()
+                && (!stillPending || alertTimeMs(kind, m_queue.at(queued.value()).task) != atMs)) {
+                m_queue[queued.value()].task = Task();
+                m_queued[kind].erase(queued);
+            }
+            QTreeWidgetItem* item = m_items[kind].value(change.taskId);
+            if (item && (!stillPending || item->data(0, Qt::UserRole + 1).toLongLong() != atMs)) {
+                removeFromPanel(kind, change.taskId);
+                removed = true;
+            }
+        }
+    }
+    if (removed) updateGroupTitles();
+}
+
+void NotificationCenter::buildPanel()
+{
+    if (m_panel) return;
+
+    m_panel = new QDialog(m_window);
+    m_panel->setWindowTitle("任务提醒");
+    m_panel->setModal(false);
+    m_panel->resize(640, 400);
+
+    m_panelSummary = new QLabel("暂无提醒", m_panel);
+    m_panelTree = new QTreeWidget(m_panel);
+    m_panelTree->setColumnCount(4);
+    m_panelTree->setHeaderLabels(QStringList() << "任务名称" << "分类" << "优先级" << "截止时间");
+    m_panelTree->header()->setSectionResizeMode(0, QHeaderView::Stretch);
+    m_panelTree->header()->setStretchLastSection(false);
+    m_panelTree->setUniformRowHeights(true);
+    for (int kind = 0; kind < DatabaseManager::AlertKindCount; ++kind) {
+        m_groups[kind] = new QTreeWidgetItem(m_panelTree);
+        m_groups[kind]->setFirstColumnSpanned(true);
+        m_groups[kind]->setExpanded(true);
+    }
+    updateGroupTitles();
+
+    QPushButton* btnClear = new QPushButton("清空", m_panel);
+    QPushButton* btnClose = new QPushButton("关闭", m_panel);
+    connect(btnClear, &QPushButton::clicked, this, &NotificationCenter::clearPanel);
+    connect(btnClose, &QPushButton::clicked, m_panel, &QDialog::hide);
+
+    QHBoxLayout* btnLayout = new QHBoxLayout;
+    btnLayout->addStretch();
+    btnLayout->addWidget(btnClear);
+    btnLayout->addWidget(btnClose);
+
+    QVBoxLayout* layout = new QVBoxLayout(m_panel);
+    layout->addWidget(m_panelSummary);
+    layout->addWidget(m_panelTree);
+    layout->addLayout(btnLayout);
+}
+
+void NotificationCenter::addToPanel(const Alert& alert)
+{
+    // 已在面板中的任务移到分组末尾（最新），内容更新
+    if (m_items[alert.kind].contains(alert.task.id)) {
+        removeFromPanel(alert.kind, alert.task.id);
+    }
+
+    const Task& task = alert.task;
+    QTreeWidgetItem* item = new QTreeWidgetItem(m_groups[alert.kind]);
+    item->setText(0, task.title);
+    item->setText(1, taskCategoryName(task.category));
+    item->setText(2, taskPriorityName(task.priority));
+    item->setText(3, task.dueTime.toString("yyyy-MM-dd HH:mm:ss"));
+    item->setData(0, Qt::UserRole, task.id);
+    item->setData(0, Qt::UserRole + 1, alertTimeMs(alert.kind, task));
+    if (alert.kind == DatabaseManager::AlertReminder && task.remindTime.isValid()) {
+        item->setToolTip(0, QString("提醒时间：%1").arg(task.remindTime.toString("yyyy-MM-dd HH:mm:ss")));
+    }
+    m_items[alert.kind].insert(task.id, item);
+
+    while (m_groups[alert.kind]->childCount() > kMaxItemsPerGroup) {
+        QTreeWidgetItem* oldest = m_groups[alert.kind]->takeChild(0);
+        m_items[alert.kind].remove(oldest->data(0, Qt::UserRole).toInt());
+        delete oldest;
+    }
+}
+
+void NotificationCenter::removeFromPanel(int kind, int taskId)
+{
+    delete m_items[kind].take(taskId);
+}
+
+void NotificationCenter::updateGroupTitles()
+{
+    if (!m_panel) return;
+    for (int kind = 0; kind < DatabaseManager::AlertKindCount; ++kind) {
+        const int count = m_groups[kind]->childCount();
+        m_groups[kind]->setText(0, QString("%1（%2）").arg(kGroupNames[kind]).arg(count));
+        m_groups[kind]->setHidden(count == 0);
+    }
+}
+
+QString NotificationCenter::summaryText(const QList<Alert>& alerts) const
+{
+    int counts[DatabaseManager::AlertKindCount] = {};
+    for (const Alert& alert : alerts) {
+        ++counts[alert.kind];
+    }
+    QStringList parts;
+    for (int kind = 0; kind < DatabaseManager::AlertKindCount; ++kind) {
+        if (counts[kind] > 0) parts << QString("%1%2个").arg(kGroupNames[kind]).arg(counts[kind]);
+    }
+    return parts.join("，");
+}
@@ -0,0 +1,70 @@
+#ifndef NOTIFICATIONCENTER_H
+#define NOTIFICATIONCENTER_H
+
+#include <QObject>
+#include <QTimer>
+#include <QList>
+#include <QHash>
+#include "reminderworker.h" // TaskAlertBatch
+#include "taskchangenotifier.h"
+
+class QWidget;
+class QDialog;
+class QLabel;
+class QTreeWidget;
+class QTreeWidgetItem;
+class QSystemTrayIcon;
+
+// 提醒通知中心：提醒先进入队列，节流后合并为一次非模态展示，界面线程不进入嵌套事件循环
+// 同一任务同种提醒在队列和面板中只保留一条（最新内容）；展示后发出alertsShown()，由提醒线程写入task_alert_log，
+// 退出时仍在队列中的提醒没有记录，下次启动重新提醒
+// 有系统托盘时弹出托盘气泡汇总，点击托盘图标打开分组面板；没有托盘时直接显示面板（不抢焦点）
+class NotificationCenter : public QObject
+{
+    Q_OBJECT
+public:
+    explicit NotificationCenter(QWidget *window, QObject *parent = nullptr);
+
+    // 排入一批提醒（节流：距上次展示不足最小间隔时等到间隔满后一并展示）
+    void enqueue(const TaskAlertBatch& batch);
+    int pendingCount() const;
+
+signals:
+    // 一批提醒已展示（托盘气泡或面板）
+    void alertsShown(const TaskAlertBatch& batch);
+
+public slots:
+    void showPanel();
+    void clearPanel();
+    // 已完成、已归档或已删除的任务，以及截止时间或提醒时间已改动的提醒，从队列和面板中移除
+    void applyTaskChanges(const QList<TaskChange>& changes);
+
+private slots:
+    void flush();
+
+private:
+    struct Alert {
+        int kind; // DatabaseManager::AlertKind
+        Task task;
+    };
+
+    void buildPanel();
+    void addToPanel(const Alert& alert);
+    void removeFromPanel(int kind, int taskId);
+    void updateGroupTitles();
+    QString summaryText(const QList<Alert>& alerts) const;
+
+    QWidget* m_window; // 面板的父窗口
+    QTimer* m_flushTimer; // 单次定时器：到期时展示队列中的全部提醒
+    QSystemTrayIcon* m_trayIcon; // 系统托盘不可用时为nullptr
+    QDialog* m_panel; // 首次展示时创建
+    QLabel* m_panelSummary;
+    QTreeWidget* m_panelTree;
+    QTreeWidgetItem* m_groups[DatabaseManager::AlertKindCount]; // 每种提醒一个分组
+    QHash<int, QTreeWidgetItem*> m_items[DatabaseManager::AlertKindCount]; // 任务ID -> 面板中的行
+    QList<Alert> m_queue; // 待展示的提醒（按到达顺序）
+    QHash<int, int> m_queued[DatabaseManager::AlertKindCount]; // 任务ID -> 在m_queue中的位置
+    qint64 m_lastFlushMs; // 上次展示时间（毫秒时间戳）
+};
+
+#endif // NOTIFICATIONCENTER_H
@@ -5,7 +5,7 @@
 #include <QDateTime>
 #include <QDebug>
 
-void PdfExporter::exportToPdf(const QList<Task>& tasks, const QString& filePath)
+void PdfExporter::exportToPdf(const DatabaseManager::TaskSource& source, const TaskStats& stats, const QString& filePath)
 {
     QPdfWriter pdfWriter(filePath);
     // 基础页面配置
@@ -71,12 +71,11 @@ void PdfExporter::exportToPdf(const QList<Task>& tasks, const QString& filePath)
                        .arg(QDateTime::currentDateTime().toString("yyyy-MM-dd HH:mm:ss"));
 
     // 统计信息
-    DatabaseManager& dbMgr = DatabaseManager::instance();
     htmlContent += QString("<div class='info'>总任务数：%1 | 已完成：%2 | 逾期未完成：%3 | 完成率：%4%%</div>")
-                       .arg(dbMgr.getTotalTaskCount())
-                       .arg(dbMgr.getCompletedTaskCount())
-                       .arg(dbMgr.getOverdueUncompletedCount())
-                       .arg(dbMgr.getCompletionRate());
+                       .arg(stats.total)
+                       .arg(stats.completed)
+                       .arg(stats.overdue)
+                       .arg(stats.completionRate());
 
     // 表格头（6列）
     htmlContent += R"(
@@ -91,29 +90,29 @@ void PdfExporter::exportToPdf(const QList<Task>& tasks, const QString& filePath)
             </tr>
     )";
 
-    // 表格内容
-    for (const Task& task : tasks) {
+    // 表格内容（超期按导出开始时刻统一判断）
+    const qint64 nowMs = QDateTime::currentMSecsSinceEpoch();
+    source([&](const Task& task) -> bool {
         // 优先级样式
-        QString priorityClass;
-        if (task.priority == "高") priorityClass = "high";
-        else if (task.priority == "中") priorityClass = "medium";
-        else if (task.priority == "低") priorityClass = "low";
+        static const char* const priorityClasses[PriorityCount] = {"high", "medium", "low"};
+        QString priorityClass = priorityClasses[task.priority < PriorityCount ? task.priority : PriorityMedium];
 
         // 逾期判断（未完成且已过期）
         QString titleClass;
-        if (task.status == 0 && task.dueTime <= QDateTime::currentDateTime()) {
+        if (task.status == 0 && task.dueTime.isValid() && task.dueTime.toMSecsSinceEpoch() <= nowMs) {
             titleClass = "overdue";
         }
 
         htmlContent += QString("<tr>")
                            .append(QString("<td class='%1'>%2</td>").arg(titleClass).arg(task.title))
-                           .append(QString("<td>%1</td>").arg(task.category))
-                           .append(QString("<td class='%1'>%2</td>").arg(priorityClass).arg(task.priority))
+                           .append(QString("<td>%1</td>").arg(taskCategoryName(task.category)))
+                           .append(QString("<td class='%1'>%2</td>").arg(priorityClass).arg(taskPriorityName(task.priority)))
                            .append(QString("<td>%1</td>").arg(task.dueTime.toString("yyyy-MM-dd HH:mm")))
-                           .append(QString("<td>%1</td>").arg(task.status == 1 ? "已完成" : "未完成"))
+                           .append(QString("<td>%1</td>").arg(taskStatusName(task.status)))
                            .append(QString("<td>%1</td>").arg(task.description))
                            .append("</tr>");
-    }
+        return true;
+    });
 
     htmlContent += R"(
         </table>
@@ -8,8 +8,8 @@
 class PdfExporter
 {
 public:
-    // 导出任务到PDF
-    static void exportToPdf(const QList<Task>& tasks, const QString& filePath);
+    // 导出任务到PDF（逐行追加到HTML，不另外构造任务列表）；统计信息由调用方预先异步读取，导出时不访问数据库
+    static void exportToPdf(const DatabaseManager::TaskSource& source, const TaskStats& stats, const QString& filePath);
 
 private:
     // 私有构造函数（静态类）
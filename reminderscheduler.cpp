@@ -0,0 +1,59 @@
+#include "reminderscheduler.h"
+#include <QDateTime>
+#include <QDebug>
+
+namespace {
+// 触发时一并发出此窗口内到期的提醒，同一时刻设置的大量提醒只唤醒一次
+const qint64 kBurstWindowMs = 500;
+}
+
+ReminderScheduler::ReminderScheduler(QObject *parent)
+    : QObject(parent)
+    , m_timer(DeadlineQueue::createTimer(this))
+{
+    connect(m_timer, &QTimer::timeout, this, &ReminderScheduler::onTimeout);
+}
+
+void ReminderScheduler::schedule(int taskId, qint64 remindAtMs)
+{
+    m_reminders.schedule(taskId, remindAtMs);
+    arm();
+}
+
+void ReminderScheduler::cancel(int taskId)
+{
+    if (!m_reminders.cancel(taskId)) return;
+    arm();
+}
+
+void ReminderScheduler::clear()
+{
+    m_reminders.clear();
+    m_timer->stop();
+}
+
+bool ReminderScheduler::isScheduled(int taskId) const
+{
+    return m_reminders.contains(taskId);
+}
+
+int ReminderScheduler::pendingCount() const
+{
+    return m_reminders.count();
+}
+
+void ReminderScheduler::arm()
+{
+    DeadlineQueue::armTimer(m_timer, m_reminders.nextDeadline());
+}
+
+void ReminderScheduler::onTimeout()
+{
+    const QList<int> dueTaskIds = m_reminders.takeUntil(QDateTime::currentMSecsSinceEpoch() + kBurstWindowMs);
+    arm();
+
+    if (!dueTaskIds.isEmpty()) {
+        qDebug() << "到期提醒：" << dueTaskIds.count() << "个任务";
+        emit remindersDue(dueTaskIds);
+    }
+}
@@ -0,0 +1,37 @@
+#ifndef REMINDERSCHEDULER_H
+#define REMINDERSCHEDULER_H
+
+#include <QObject>
+#include <QTimer>
+#include <QList>
+#include "deadlinequeue.h"
+
+// 任务提醒调度器：所有待触发的提醒共用一个定时器，定时器只为最近的提醒安排
+class ReminderScheduler : public QObject
+{
+    Q_OBJECT
+public:
+    explicit ReminderScheduler(QObject *parent = nullptr);
+
+    // 安排或改期任务的提醒（毫秒时间戳），每个任务只保留最后一次安排
+    void schedule(int taskId, qint64 remindAtMs);
+    void cancel(int taskId);
+    void clear();
+    bool isScheduled(int taskId) const;
+    int pendingCount() const;
+
+signals:
+    // 到期的提醒：时间相近（同一触发窗口内）的提醒合并为一批发出
+    void remindersDue(const QList<int>& taskIds);
+
+private slots:
+    void onTimeout();
+
+private:
+    void arm(); // 按最近的提醒时间安排定时器
+
+    QTimer* m_timer;
+    DeadlineQueue m_reminders; // 任务ID -> 提醒时间
+};
+
+#endif // REMINDERSCHEDULER_H
@@ -1,16 +1,25 @@
 #include "reminderworker.h"
+#include "reminderscheduler.h"
 #include <QDebug>
 #include <QDateTime>
 
 ReminderWorker::ReminderWorker(QObject *parent)
     : QObject(parent)
-    , m_checkTimer(new QTimer(this))
+    , m_wakeTimer(new QTimer(this))
+    , m_reminderScheduler(new ReminderScheduler(this))
+    , m_maxSleepMs(60 * 60 * 1000) // 最长休眠1小时
+    , m_running(false)
+    , m_checkedAtMs(0)
     , m_upcomingMinutes(30) // 提前30分钟提醒即将到期任务
 {
-    // 默认检查间隔10秒（可通过setCheckInterval修改）
-    m_checkTimer->setInterval(10000);
-    // 连接定时器超时信号到统一检查槽
-    connect(m_checkTimer, &QTimer::timeout, this, &ReminderWorker::checkTasks);
+    // 提醒批次需跨线程排队传递
+    qRegisterMetaType<TaskAlertBatch>("TaskAlertBatch");
+
+    // 按截止时间精确唤醒（阈值跨过后1毫秒内触发）
+    m_wakeTimer->setSingleShot(true);
+    m_wakeTimer->setTimerType(Qt::PreciseTimer);
+    connect(m_wakeTimer, &QTimer::timeout, this, &ReminderWorker::checkTasks);
+    connect(m_reminderScheduler, &ReminderScheduler::remindersDue, this, &ReminderWorker::onRemindersDue);
 }
 
 ReminderWorker::~ReminderWorker()
@@ -26,28 +35,43 @@ void ReminderWorker::setUpcomingReminderThreshold(int minutes)
     }
 }
 
-// 设置检查间隔（毫秒）
+// 设置最长休眠间隔（毫秒）
 void ReminderWorker::setCheckInterval(int intervalMs)
 {
     if (intervalMs > 0) {
-        m_checkTimer->setInterval(intervalMs);
-        qDebug() << "提醒检查间隔已更新为：" << intervalMs << "毫秒";
+        m_maxSleepMs = intervalMs;
+        qDebug() << "提醒最长休眠间隔已更新为：" << intervalMs << "毫秒";
     }
 }
 
 void ReminderWorker::startChecking()
 {
-    qDebug() << "提醒工作线程开始检查任务（逾期 + 即将到期）";
-    // 立即执行一次检查
-    checkTasks();
-    // 启动定时器
-    m_checkTimer->start();
+    qDebug() << "提醒工作线程开始检查任务（逾期 + 即将到期 + 自定义提醒）";
+    m_running = true;
+
+    DatabaseManager& db = DatabaseManager::instance();
+    for (int kind = 0; kind < DatabaseManager::AlertKindCount; ++kind) {
+        m_alerted[kind] = db.getAlertLog(static_cast<DatabaseManager::AlertKind>(kind));
+    }
+
+    // 自定义提醒只登记时间，由调度器为最近的一个计时
+    const qint64 nowMs = QDateTime::currentMSecsSinceEpoch();
+    db.forEachTask(DatabaseManager::ActiveTasks, [this, nowMs](const Task& task) -> bool {
+        scheduleReminder(task, nowMs);
+        return true;
+    });
+    qDebug() << "已登记任务提醒：" << m_reminderScheduler->pendingCount() << "个";
+
+    // 立即全量检查一次，之后只在阈值跨过时唤醒
+    checkAllTasks();
 }
 
 void ReminderWorker::stop()
 {
-    if (m_checkTimer->isActive()) {
-        m_checkTimer->stop();
+    m_running = false;
+    m_reminderScheduler->clear();
+    if (m_wakeTimer->isActive()) {
+        m_wakeTimer->stop();
         qDebug() << "提醒工作线程停止检查任务";
     }
 }
@@ -55,58 +79,199 @@ void ReminderWorker::stop()
 // 重置已提醒任务记录
 void ReminderWorker::resetRemindedTasks()
 {
-    m_remindedOverdueTaskIds.clear();
-    m_remindedUpcomingTaskIds.clear();
+    for (int kind = 0; kind < DatabaseManager::AlertKindCount; ++kind) {
+        m_alerted[kind].clear();
+    }
     qDebug() << "已重置所有任务提醒记录";
 }
 
-// 统一检查逾期任务 + 即将到期任务（过滤重复提醒）
-void ReminderWorker::checkTasks()
+qint64 ReminderWorker::upcomingWindowMs() const
+{
+    return qint64(m_upcomingMinutes) * 60 * 1000;
+}
+
+bool ReminderWorker::markAlerted(DatabaseManager::AlertKind kind, int taskId, qint64 atMs)
+{
+    QHash<int, qint64>::iterator it = m_alerted[kind].find(taskId);
+    if (it != m_alerted[kind].end() && it.value() == atMs) return false;
+    m_alerted[kind].insert(taskId, atMs);
+    return true;
+}
+
+void ReminderWorker::deliver(const TaskAlertBatch& batch)
 {
-    qDebug() << "正在检查任务（逾期 + 即将到期）";
-    QDateTime currentTime = QDateTime::currentDateTime();
-    QDateTime upcomingThreshold = currentTime.addSecs(m_upcomingMinutes * 60); // 分钟转秒，兼容所有Qt版本
-
-    // 1. 逾期任务提醒（仅提醒未标记过的任务）
-    QList<Task> overdueTasks = DatabaseManager::instance().getOverdueUncompletedTasks();
-    QList<Task> newOverdueTasks; // 待发送提醒的新逾期任务
-    for (const Task& task : overdueTasks) {
-        // 未标记过已提醒，才加入待提醒列表
-        if (!m_remindedOverdueTaskIds.contains(task.id)) {
-            newOverdueTasks.append(task);
-            m_remindedOverdueTaskIds.insert(task.id); // 标记为已提醒
+    // 提醒记录等界面展示后再写入（recordShownAlerts()）
+    if (batch.isEmpty()) return;
+
+    qDebug() << "发送提醒：逾期" << batch.overdue.count() << "个，即将到期" << batch.upcoming.count()
+             << "个，自定义提醒" << batch.reminders.count() << "个";
+    emit alertsReady(batch);
+}
+
+void ReminderWorker::recordShownAlerts(const TaskAlertBatch& batch)
+{
+    // 提醒针对的时间：逾期与即将到期为截止时间，自定义提醒为提醒时间
+    const QList<Task>* lists[DatabaseManager::AlertKindCount] = { &batch.overdue, &batch.upcoming, &batch.reminders };
+    DatabaseManager& db = DatabaseManager::instance();
+    for (int kind = 0; kind < DatabaseManager::AlertKindCount; ++kind) {
+        QList<QPair<int, qint64>> alerts;
+        alerts.reserve(lists[kind]->count());
+        for (const Task& task : *lists[kind]) {
+            const QDateTime& at = kind == DatabaseManager::AlertReminder ? task.remindTime : task.dueTime;
+            if (at.isValid()) alerts.append(qMakePair(task.id, at.toMSecsSinceEpoch()));
         }
+        db.recordAlerts(static_cast<DatabaseManager::AlertKind>(kind), alerts);
     }
-    // 有新逾期任务发送信号
-    if (!newOverdueTasks.isEmpty()) {
-        emit taskOverdue(newOverdueTasks);
-        qDebug() << "检测到" << newOverdueTasks.count() << "个新逾期任务，发送提醒";
-    }
+}
 
-    // 2. 即将到期任务提醒（仅提醒未标记过的任务）
-    QList<Task> allTasks = DatabaseManager::instance().getAllTasks();
-    QList<Task> newUpcomingTasks; // 待发送提醒的新即将到期任务
-    for (const Task& task : allTasks) {
-        // 筛选条件：未完成 + 未超期 + 截止时间在当前时间到阈值时间之间
-        if (task.status != 0) {
-            continue; // 跳过已完成的任务
+// 全量检查逾期任务 + 即将到期任务（过滤已提醒的任务）
+void ReminderWorker::checkAllTasks()
+{
+    const qint64 nowMs = QDateTime::currentMSecsSinceEpoch();
+    TaskAlertBatch batch;
+    // 1. 逾期任务提醒：逐行读取，只保留尚未针对当前截止时间提醒过的任务
+    DatabaseManager::instance().forEachOverdueUncompletedTask([this, &batch](const Task& task) -> bool {
+        if (markAlerted(DatabaseManager::AlertOverdue, task.id, task.dueTime.toMSecsSinceEpoch())) {
+            batch.overdue.append(task);
+        }
+        return true;
+    });
+
+    // 2. 即将到期任务提醒
+    // 未完成 + 未超期 + 截止时间在当前时间到阈值时间之间，由截止时间索引范围查询直接得到
+    DatabaseManager::instance().forEachUpcomingTask(m_upcomingMinutes, [this, &batch](const Task& task) -> bool {
+        if (markAlerted(DatabaseManager::AlertUpcoming, task.id, task.dueTime.toMSecsSinceEpoch())) {
+            batch.upcoming.append(task);
         }
-        if (task.dueTime < currentTime) {
-            continue; // 跳过已超期的任务
+        return true;
+    });
+
+    m_checkedAtMs = nowMs;
+    deliver(batch);
+    scheduleNextWake(nowMs);
+}
+
+// 唤醒检查：上次检查之后跨过阈值的任务只可能落在截止时间索引的两段区间内
+void ReminderWorker::checkTasks()
+{
+    if (!m_running) return;
+    const qint64 nowMs = QDateTime::currentMSecsSinceEpoch();
+    const qint64 windowMs = upcomingWindowMs();
+    DatabaseManager& db = DatabaseManager::instance();
+    TaskAlertBatch batch;
+
+    // 1. 新逾期：截止时间在[上次检查, 当前时间)内的未完成任务（已完成的任务不读取）
+    db.forEachUncompletedTaskDueBetween(QDateTime::fromMSecsSinceEpoch(m_checkedAtMs),
+                                        QDateTime::fromMSecsSinceEpoch(nowMs - 1),
+                                        [this, &batch](const Task& task) -> bool {
+        if (markAlerted(DatabaseManager::AlertOverdue, task.id, task.dueTime.toMSecsSinceEpoch())) {
+            batch.overdue.append(task);
         }
-        if (task.dueTime > upcomingThreshold) {
-            continue; // 跳过未到提醒时间的任务
+        return true;
+    });
+
+    // 2. 新进入即将到期窗口：截止时间在(上次检查 + 阈值, 当前时间 + 阈值]内（已逾期的由第1步处理）
+    db.forEachUncompletedTaskDueBetween(QDateTime::fromMSecsSinceEpoch(qMax(m_checkedAtMs + windowMs + 1, nowMs)),
+                                        QDateTime::fromMSecsSinceEpoch(nowMs + windowMs),
+                                        [this, &batch](const Task& task) -> bool {
+        if (markAlerted(DatabaseManager::AlertUpcoming, task.id, task.dueTime.toMSecsSinceEpoch())) {
+            batch.upcoming.append(task);
         }
+        return true;
+    });
 
-        // 未标记过已提醒，才加入待提醒列表
-        if (!m_remindedUpcomingTaskIds.contains(task.id)) {
-            newUpcomingTasks.append(task);
-            m_remindedUpcomingTaskIds.insert(task.id); // 标记为已提醒
+    m_checkedAtMs = nowMs;
+    deliver(batch);
+    scheduleNextWake(nowMs);
+}
+
+void ReminderWorker::onRemindersDue(const QList<int>& taskIds)
+{
+    // 跳过触发前已删除、归档或完成的任务
+    TaskAlertBatch batch;
+    for (int taskId : taskIds) {
+        Task task = DatabaseManager::instance().getTaskById(taskId);
+        if (!task.isValid() || task.is_archived || task.status != StatusUncompleted || !task.remindTime.isValid()) {
+            continue;
+        }
+        if (markAlerted(DatabaseManager::AlertReminder, task.id, task.remindTime.toMSecsSinceEpoch())) {
+            batch.reminders.append(task);
         }
     }
-    // 有新即将到期任务才发送信号
-    if (!newUpcomingTasks.isEmpty()) {
-        emit taskUpcoming(newUpcomingTasks);
-        qDebug() << "检测到" << newUpcomingTasks.count() << "个新即将到期任务，发送提醒";
+    deliver(batch);
+}
+
+void ReminderWorker::scheduleReminder(const Task& task, qint64 nowMs)
+{
+    // 提醒时间已过、任务已完成或已针对该时间提醒过：取消；否则改期（调度器中每个任务只保留最后一次安排）
+    const qint64 remindMs = task.remindTime.isValid() ? task.remindTime.toMSecsSinceEpoch() : -1;
+    if (task.is_archived || task.status != StatusUncompleted || remindMs <= nowMs
+        || m_alerted[DatabaseManager::AlertReminder].value(task.id, -1) == remindMs) {
+        m_reminderScheduler->cancel(task.id);
+        return;
     }
+    m_reminderScheduler->schedule(task.id, remindMs);
+}
+
+void ReminderWorker::onTasksChanged(const QList<TaskChange>& changes)
+{
+    if (!m_running) return;
+    const qint64 nowMs = QDateTime::currentMSecsSinceEpoch();
+    const qint64 windowMs = upcomingWindowMs();
+
+    // 变更的任务可能被改到已检查过的时间段内，直接按当前状态判断
+    TaskAlertBatch batch;
+    for (const TaskChange& change : changes) {
+        switch (change.type) {
+        case TaskChange::Deleted:
+            // 提醒记录由数据库触发器随任务删除
+            for (int kind = 0; kind < DatabaseManager::AlertKindCount; ++kind) {
+                m_alerted[kind].remove(change.taskId);
+            }
+            m_reminderScheduler->cancel(change.taskId);
+            break;
+        case TaskChange::Archived:
+            m_reminderScheduler->cancel(change.taskId);
+            break;
+        case TaskChange::Inserted:
+        case TaskChange::Updated:
+        case TaskChange::Restored: {
+            const Task& task = change.task;
+            if (!task.isValid()) break;
+            scheduleReminder(task, nowMs);
+            if (task.is_archived || task.status != StatusUncompleted || !task.dueTime.isValid()) break;
+
+            const qint64 dueMs = task.dueTime.toMSecsSinceEpoch();
+            if (dueMs < nowMs) {
+                if (markAlerted(DatabaseManager::AlertOverdue, task.id, dueMs)) batch.overdue.append(task);
+            } else if (dueMs <= nowMs + windowMs) {
+                if (markAlerted(DatabaseManager::AlertUpcoming, task.id, dueMs)) batch.upcoming.append(task);
+            }
+            break;
+        }
+        case TaskChange::TagsChanged:
+            break;
+        }
+    }
+
+    deliver(batch);
+    // 变更可能带来更早的截止时间
+    scheduleNextWake(nowMs);
+}
+
+void ReminderWorker::scheduleNextWake(qint64 nowMs)
+{
+    if (!m_running) return;
+    DatabaseManager& db = DatabaseManager::instance();
+    const qint64 windowMs = upcomingWindowMs();
+    qint64 wakeMs = nowMs + m_maxSleepMs;
+
+    // 最近一个尚未逾期的截止时间：过了该时刻1毫秒即逾期
+    const qint64 nextDueMs = db.nextUncompletedDueTime(nowMs);
+    if (nextDueMs >= 0) wakeMs = qMin(wakeMs, nextDueMs + 1);
+    // 最近一个尚未进入即将到期窗口的截止时间：提前阈值时长进入窗口
+    const qint64 nextUpcomingMs = db.nextUncompletedDueTime(nowMs + windowMs + 1);
+    if (nextUpcomingMs >= 0) wakeMs = qMin(wakeMs, nextUpcomingMs - windowMs);
+
+    m_wakeTimer->start(int(qMax<qint64>(0, wakeMs - nowMs)));
 }
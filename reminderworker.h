@@ -4,10 +4,29 @@
 #include <QObject>
 #include <QTimer>
 #include <QList>
-#include <QSet>
+#include <QHash>
+#include <QPair>
+#include <QMetaType>
 #include "databasemanager.h"
+#include "taskchangenotifier.h"
 
-// 提醒工作类（Worker + moveToThread模式）
+class ReminderScheduler;
+
+// 一次检查得到的全部提醒（按种类分组），整批排队发送到界面线程
+struct TaskAlertBatch {
+    QList<Task> overdue;   // 新逾期
+    QList<Task> upcoming;  // 新进入即将到期窗口
+    QList<Task> reminders; // 自定义提醒时间已到
+
+    bool isEmpty() const { return overdue.isEmpty() && upcoming.isEmpty() && reminders.isEmpty(); }
+};
+Q_DECLARE_METATYPE(TaskAlertBatch)
+
+// 提醒工作类（Worker + moveToThread模式）：逾期、即将到期与自定义提醒的唯一来源，界面线程不做任何扫描
+// 不轮询：按索引查出下一个会跨过阈值（逾期或进入即将到期窗口）的截止时间，休眠到该时刻；
+// 自定义提醒由单定时器调度器安排；任务变更通知到达时检查变更的任务并重新安排唤醒时间
+// 已提醒状态在界面展示后（recordShownAlerts()）才写入task_alert_log，重启后不重复提醒，
+// 退出时仍在界面队列中未展示的提醒下次启动时重新发出
 class ReminderWorker : public QObject
 {
     Q_OBJECT
@@ -17,36 +36,53 @@ public:
 
     // 设置即将到期提醒阈值（提前X分钟）
     void setUpcomingReminderThreshold(int minutes = 30);
-    // 设置检查间隔（毫秒）
+    // 设置最长休眠间隔（毫秒）：下一个截止时间很远时也按此间隔醒来，防止系统休眠或调整时钟后错过
     void setCheckInterval(int intervalMs);
 
 signals:
-    // 逾期任务信号
-    void taskOverdue(const QList<Task>& overdueTasks);
-    // 即将到期任务信号
-    void taskUpcoming(const QList<Task>& upcomingTasks);
+    // 新产生的提醒（每次检查至多发出一次）
+    void alertsReady(const TaskAlertBatch& batch);
 
 public slots:
-    // 启动检查定时器
+    // 读取提醒记录、登记自定义提醒，全量检查一次并开始按截止时间唤醒
     void startChecking();
-    // 停止检查定时器
+    // 停止唤醒
     void stop();
-    // 重置已提醒任务记录（任务状态变更后调用）
+    // 重置已提醒任务记录（只影响本次运行，已写入的提醒记录保留）
     void resetRemindedTasks();
+    // 任务变更通知（由界面线程排队发送）：只检查变更的任务，并按新的截止时间重新安排唤醒
+    void onTasksChanged(const QList<TaskChange>& changes);
+    // 界面已展示的提醒（由界面线程排队发送）：写入提醒记录
+    void recordShownAlerts(const TaskAlertBatch& batch);
 
 private slots:
-    // 统一检查逾期任务 + 即将到期任务
+    // 唤醒：只检查上次检查以来跨过阈值的任务（截止时间索引上的两段小范围）
     void checkTasks();
+    // 自定义提醒到期（同一触发窗口内的提醒为一批）
+    void onRemindersDue(const QList<int>& taskIds);
 
 private:
-    // 检查定时器
-    QTimer* m_checkTimer;
+    void checkAllTasks(); // 启动时全量检查
+    // 未针对atMs提醒过则标记并返回true（只记在内存中，界面展示后才写入数据库）
+    bool markAlerted(DatabaseManager::AlertKind kind, int taskId, qint64 atMs);
+    // 发出本批提醒
+    void deliver(const TaskAlertBatch& batch);
+    // 按任务当前的提醒时间安排或取消自定义提醒
+    void scheduleReminder(const Task& task, qint64 nowMs);
+    // 休眠到下一个截止时间跨过阈值的时刻（最长m_maxSleepMs）
+    void scheduleNextWake(qint64 nowMs);
+    qint64 upcomingWindowMs() const;
+
+    // 单次唤醒定时器
+    QTimer* m_wakeTimer;
+    ReminderScheduler* m_reminderScheduler; // 自定义提醒（全部共用一个定时器）
+    int m_maxSleepMs;
+    bool m_running;
+    qint64 m_checkedAtMs; // 上次检查的时刻：截止时间在此之前跨过阈值的任务均已检查
     // 即将到期提醒阈值（分钟）
     int m_upcomingMinutes;
-    // 已提醒的逾期任务ID集合（避免重复提醒）
-    QSet<int> m_remindedOverdueTaskIds;
-    // 已提醒的即将到期任务ID集合（避免重复提醒）
-    QSet<int> m_remindedUpcomingTaskIds;
+    // 已提醒记录（按种类）：任务ID -> 提醒所针对的时间
+    QHash<int, qint64> m_alerted[DatabaseManager::AlertKindCount];
 };
 
 #endif // REMINDERWORKER_H
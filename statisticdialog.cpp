@@ -2,6 +2,7 @@
 #include "ui_statisticdialog.h"
 #include "databasemanager.h"
 #include "tasktablemodel.h"
+#include "asyncdatabase.h"
 #include <QChartView>
 #include <QPieSeries>
 #include <QPieSlice>
@@ -14,6 +15,8 @@
 #include <QPainter>
 #include <QMap>
 #include <QDir>
+#include <QVector>
+#include <QtConcurrent>
 
 
 void StatisticDialog::on_radioBtnToday_clicked() { generateReport(); }
@@ -24,6 +27,7 @@ StatisticDialog::StatisticDialog(QWidget *parent)
     , ui(new Ui::StatisticDialog)
     , m_pieChart(new QChart())
     , m_lineChart(new QChart())
+    , m_reportRequest(0)
 {
     ui->setupUi(this);
     this->setModal(true);
@@ -65,37 +69,72 @@ void StatisticDialog::generateReport()
         m_endTime = QDateTime::currentDateTime().date().addDays(7 - weekDay).endOfDay();
     }
 
-    // 2. 获取时间范围内的任务
-    QList<Task> allTasks = DatabaseManager::instance().getAllTasks();
-    QList<Task> timeRangeTasks;
-    for (const Task& task : allTasks) {
-        if (task.dueTime >= m_startTime && task.dueTime <= m_endTime) {
-            timeRangeTasks.append(task);
+    // 2. 折线图时间节点（今日每2小时1个节点，本周每天1个节点）
+    QList<QDateTime> nodes;
+    if (ui->radioBtnToday->isChecked()) {
+        for (int hour = 0; hour < 24; hour += 2) {
+            nodes.append(m_startTime.addSecs(hour * 3600));
+        }
+    } else {
+        for (int day = 0; day < 7; day++) {
+            nodes.append(m_startTime.addDays(day));
         }
     }
 
-    // 3. 生成饼图
+    // 3. 在列式数据上聚合时间范围内的任务：范围二分定位，分类计数与节点计数在连续数组上一次完成（行多时多核并行）
+    // 每个任务只计入第一个不早于其截止时间的节点，之后求前缀和
+    // 列式数据来自内存仓库，不访问数据库：构建与聚合都在全局线程池中执行，不占用数据库线程；
+    // 结果到达后再绘制（期间切换了时间范围则只绘制最后一次）
+    QVector<qint64> nodeMs;
+    nodeMs.reserve(nodes.count());
+    for (const QDateTime& node : nodes) {
+        nodeMs.append(node.toMSecsSinceEpoch());
+    }
+    const qint64 fromMs = m_startTime.toMSecsSinceEpoch();
+    const qint64 toMs = m_endTime.toMSecsSinceEpoch();
+    const int request = ++m_reportRequest;
+    QFuture<TaskColumnReport> future = QtConcurrent::run([fromMs, toMs, nodeMs]() {
+        TaskColumnsPtr columns = DatabaseManager::instance().activeTaskColumns();
+        return TaskColumnReport::reduce(*columns, fromMs, toMs, nodeMs, QDateTime::currentMSecsSinceEpoch());
+    });
+    AsyncDatabase::whenReady(future, this, [this, request, nodes](const TaskColumnReport& report) {
+        if (request == m_reportRequest) showReport(nodes, report);
+    });
+}
+
+void StatisticDialog::showReport(const QList<QDateTime>& nodes, const TaskColumnReport& report)
+{
+    const int* categoryCounts = report.byCategory;
+    QVector<int> nodeTotals = report.bucketTotals;
+    QVector<int> nodeCompleted = report.bucketCompleted;
+    for (int i = 1; i < nodes.count(); ++i) {
+        nodeTotals[i] += nodeTotals[i - 1];
+        nodeCompleted[i] += nodeCompleted[i - 1];
+    }
+
+    // 4. 生成饼图
     m_pieChart->removeAllSeries();
     QPieSeries* pieSeries = new QPieSeries();
-    QMap<QString, int> categoryCountMap{{"工作",0}, {"学习",0}, {"生活",0}, {"其他",0}};
-    for (const Task& task : timeRangeTasks) {
-        if (categoryCountMap.contains(task.category)) categoryCountMap[task.category]++;
-    }
-    for (auto it = categoryCountMap.begin(); it != categoryCountMap.end(); ++it) {
-        if (it.value() > 0) {
-            QPieSlice* slice = pieSeries->append(QString("%1（%2个）").arg(it.key()).arg(it.value()), it.value());
+    const QColor categoryColors[CategoryCount] = {
+        QColor(255, 107, 107), // 工作
+        QColor(107, 185, 255), // 学习
+        QColor(129, 207, 129), // 生活
+        QColor(255, 204, 128)  // 其他
+    };
+    for (int category = 0; category < CategoryCount; ++category) {
+        int count = categoryCounts[category];
+        if (count > 0) {
+            const QString& name = taskCategoryName(static_cast<TaskCategory>(category));
+            QPieSlice* slice = pieSeries->append(QString("%1（%2个）").arg(name).arg(count), count);
             slice->setLabelVisible(true);
-            if (it.key() == "工作") slice->setColor(QColor(255, 107, 107));
-            else if (it.key() == "学习") slice->setColor(QColor(107, 185, 255));
-            else if (it.key() == "生活") slice->setColor(QColor(129, 207, 129));
-            else slice->setColor(QColor(255, 204, 128));
+            slice->setColor(categoryColors[category]);
         }
     }
     m_pieChart->addSeries(pieSeries);
     m_pieChart->setTitle(QString("任务分类占比（%1 至 %2）").arg(m_startTime.toString("yyyy-MM-dd")).arg(m_endTime.toString("yyyy-MM-dd")));
     m_pieChart->createDefaultAxes();
 
-    // 4. 生成折线图（今日用“小时数字”，本周用“月-日”）
+    // 5. 生成折线图（今日用“小时数字”，本周用“月-日”）
     m_lineChart->removeAllSeries();
     qDeleteAll(m_lineChart->axes());
     QLineSeries* lineSeries = new QLineSeries();
@@ -116,24 +155,8 @@ void StatisticDialog::generateReport()
 
     // 计算完成率并填充数据（X轴用索引，后续绑定分类轴）
     for (int i = 0; i < xLabels.count(); ++i) {
-        QDateTime node;
-        if (ui->radioBtnToday->isChecked()) {
-            // 今日：根据索引计算对应的时间节点
-            int hour = i * 2;  // 每2小时一个节点
-            node = m_startTime.addSecs(hour * 3600);
-        } else {
-            // 本周：根据索引计算对应的时间节点
-            node = m_startTime.addDays(i);
-        }
-
-        // 统计该时间节点前的任务完成率
-        int total = 0, completed = 0;
-        for (const Task& task : timeRangeTasks) {
-            if (task.dueTime <= node) {
-                total++;
-                if (task.status == 1) completed++;
-            }
-        }
+        // 该时间节点前的任务完成率
+        int total = nodeTotals.value(i), completed = nodeCompleted.value(i);
         double rate = (total > 0) ? (static_cast<double>(completed)/total)*100 : 0.0;
         lineSeries->append(i, rate);  // X轴用索引
     }
@@ -161,13 +184,9 @@ void StatisticDialog::generateReport()
     m_lineChart->addAxis(xAxis, Qt::AlignBottom);
     lineSeries->attachAxis(xAxis);
 
-    // 更新信息标签
-    int totalTask = timeRangeTasks.count(), completedTask = 0, overdueTask = 0;
-    for (const Task& task : timeRangeTasks) {
-        if (task.status == 1) completedTask++;
-        if (task.dueTime < QDateTime::currentDateTime() && task.status == 0) overdueTask++;
-    }
-    double completionRate = (totalTask > 0) ? (static_cast<double>(completedTask)/totalTask)*100 : 0.0;
+    // 更新信息标签（与图表共用同一次聚合结果）
+    int totalTask = report.total, completedTask = report.completed, overdueTask = report.overdue;
+    double completionRate = report.completionRate();
     ui->labelInfo->setText(
         QString("报表时间范围：%1 ~ %2\n")
             .arg(m_startTime.toString("yyyy-MM-dd HH:mm"))
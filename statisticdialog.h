@@ -9,6 +9,7 @@
 #include <QLineSeries>
 #include <QValueAxis>
 #include <QChartView>
+#include "taskcolumns.h"
 
 namespace Ui {
 class StatisticDialog;
@@ -29,11 +30,15 @@ private slots:
     void on_radioBtnWeek_clicked();
 
 private:
+    // 按聚合结果绘制饼图、折线图与信息标签
+    void showReport(const QList<QDateTime>& nodes, const TaskColumnReport& report);
+
     Ui::StatisticDialog *ui;
     QChart* m_pieChart;       // 直接用QChart（无需命名空间）
     QChart* m_lineChart;
     QDateTime m_startTime;
     QDateTime m_endTime;
+    int m_reportRequest; // 报表聚合请求序号：只绘制最后一次请求的结果
 };
 
 #endif // STATISTICDIALOG_H
@@ -0,0 +1,39 @@
+#include "task.h"
+
+namespace {
+// 与数据库CHECK约束中的取值一致，顺序与枚举一致
+const QString kCategoryNames[CategoryCount] = {"工作", "学习", "生活", "其他"};
+const QString kPriorityNames[PriorityCount] = {"高", "中", "低"};
+const QString kStatusNames[2] = {"未完成", "已完成"};
+}
+
+const QString& taskCategoryName(TaskCategory category)
+{
+    return kCategoryNames[category < CategoryCount ? category : CategoryOther];
+}
+
+TaskCategory taskCategoryFromName(const QString& name)
+{
+    for (int i = 0; i < CategoryCount; ++i) {
+        if (kCategoryNames[i] == name) return static_cast<TaskCategory>(i);
+    }
+    return CategoryOther;
+}
+
+const QString& taskPriorityName(TaskPriority priority)
+{
+    return kPriorityNames[priority < PriorityCount ? priority : PriorityMedium];
+}
+
+TaskPriority taskPriorityFromName(const QString& name)
+{
+    for (int i = 0; i < PriorityCount; ++i) {
+        if (kPriorityNames[i] == name) return static_cast<TaskPriority>(i);
+    }
+    return PriorityMedium;
+}
+
+const QString& taskStatusName(TaskStatus status)
+{
+    return kStatusNames[status == StatusCompleted ? 1 : 0];
+}
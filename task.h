@@ -0,0 +1,53 @@
+#ifndef TASK_H
+#define TASK_H
+
+#include <QString>
+#include <QDateTime>
+
+// 任务分类（取值顺序与界面下拉框一致）
+enum TaskCategory : quint8 {
+    CategoryWork = 0,  // 工作
+    CategoryStudy,     // 学习
+    CategoryLife,      // 生活
+    CategoryOther,     // 其他
+    CategoryCount
+};
+
+// 任务优先级（取值顺序与界面下拉框一致）
+enum TaskPriority : quint8 {
+    PriorityHigh = 0,  // 高
+    PriorityMedium,    // 中
+    PriorityLow,       // 低
+    PriorityCount
+};
+
+// 任务状态
+enum TaskStatus : quint8 {
+    StatusUncompleted = 0, // 未完成
+    StatusCompleted = 1    // 已完成
+};
+
+// 枚举与文本互转：仅在显示、导出和数据库读写边界使用
+const QString& taskCategoryName(TaskCategory category);
+TaskCategory taskCategoryFromName(const QString& name); // 无法识别时返回CategoryOther
+const QString& taskPriorityName(TaskPriority priority);
+TaskPriority taskPriorityFromName(const QString& name); // 无法识别时返回PriorityMedium
+const QString& taskStatusName(TaskStatus status);
+
+struct Task {
+    int id = -1;
+    // 小整数字段集中存放，减少结构体填充
+    TaskCategory category = CategoryWork;
+    TaskPriority priority = PriorityHigh;
+    TaskStatus status = StatusUncompleted; // 0:未完成 1:已完成
+    quint8 is_archived = 0; // 0:未归档 1:已归档
+    quint8 progress = 0; // 任务进度 0~100
+    QString title;
+    QString description;
+    QDateTime dueTime;
+    QDateTime remindTime;
+
+    bool isValid() const { return id != -1 && !title.isEmpty(); }
+};
+
+#endif // TASK_H
@@ -0,0 +1,358 @@
+#include "taskbitmap.h"
+#include <QtAlgorithms>
+#include <algorithm>
+#include <iterator>
+
+void TaskBitmap::toWords(Container& container)
+{
+    if (!container.words.isEmpty()) return;
+    container.words.fill(0, kWordCount);
+    for (quint16 low : container.array) {
+        container.words[low >> 6] |= quint64(1) << (low & 63);
+    }
+    container.array.clear();
+    container.array.squeeze();
+}
+
+void TaskBitmap::toArrayIfSparse(Container& container)
+{
+    if (container.words.isEmpty() || container.cardinality > kArrayMaxSize) return;
+    container.array.reserve(container.cardinality);
+    for (int word = 0; word < kWordCount; ++word) {
+        quint64 bits = container.words.at(word);
+        while (bits) {
+            const int bit = qCountTrailingZeroBits(bits);
+            container.array.append(quint16((word << 6) | bit));
+            bits &= bits - 1;
+        }
+    }
+    container.words.clear();
+    container.words.squeeze();
+}
+
+bool TaskBitmap::containerContains(const Container& container, quint16 low)
+{
+    if (!container.words.isEmpty()) {
+        return (container.words.at(low >> 6) >> (low & 63)) & 1;
+    }
+    return std::binary_search(container.array.constBegin(), container.array.constEnd(), low);
+}
+
+void TaskBitmap::add(int value)
+{
+    Container& container = m_containers[value >> 16];
+    const quint16 low = quint16(value & 0xFFFF);
+    if (!container.words.isEmpty()) {
+        quint64& word = container.words[low >> 6];
+        const quint64 mask = quint64(1) << (low & 63);
+        if (!(word & mask)) {
+            word |= mask;
+            ++container.cardinality;
+        }
+        return;
+    }
+
+    QVector<quint16>::iterator it = std::lower_bound(container.array.begin(), container.array.end(), low);
+    if (it != container.array.end() && *it == low) return;
+    container.array.insert(it, low);
+    ++container.cardinality;
+    if (container.cardinality > kArrayMaxSize) {
+        toWords(container);
+    }
+}
+
+void TaskBitmap::remove(int value)
+{
+    QMap<int, Container>::iterator found = m_containers.find(value >> 16);
+    if (found == m_containers.end()) return;
+
+    Container& container = found.value();
+    const quint16 low = quint16(value & 0xFFFF);
+    if (!container.words.isEmpty()) {
+        quint64& word = container.words[low >> 6];
+        const quint64 mask = quint64(1) << (low & 63);
+        if (!(word & mask)) return;
+        word &= ~mask;
+        --container.cardinality;
+        toArrayIfSparse(container);
+    } else {
+        QVector<quint16>::iterator it = std::lower_bound(container.array.begin(), container.array.end(), low);
+        if (it == container.array.end() || *it != low) return;
+        container.array.erase(it);
+        --container.cardinality;
+    }
+    if (container.cardinality == 0) {
+        m_containers.erase(found);
+    }
+}
+
+bool TaskBitmap::contains(int value) const
+{
+    QMap<int, Container>::const_iterator found = m_containers.constFind(value >> 16);
+    return found != m_containers.constEnd() && containerContains(found.value(), quint16(value & 0xFFFF));
+}
+
+int TaskBitmap::count() const
+{
+    int total = 0;
+    for (const Container& container : m_containers) {
+        total += container.cardinality;
+    }
+    return total;
+}
+
+bool TaskBitmap::isEmpty() const
+{
+    return m_containers.isEmpty();
+}
+
+void TaskBitmap::clear()
+{
+    m_containers.clear();
+}
+
+TaskBitmap::Container TaskBitmap::intersect(const Container& a, const Container& b)
+{
+    Container result;
+    if (!a.words.isEmpty() && !b.words.isEmpty()) {
+        result.words.resize(kWordCount);
+        for (int i = 0; i < kWordCount; ++i) {
+            result.words[i] = a.words.at(i) & b.words.at(i);
+            result.cardinality += qPopulationCount(result.words.at(i));
+        }
+        toArrayIfSparse(result);
+    } else if (a.words.isEmpty() && b.words.isEmpty()) {
+        std::set_intersection(a.array.constBegin(), a.array.constEnd(), b.array.constBegin(), b.array.constEnd(),
+                              std::back_inserter(result.array));
+        result.cardinality = result.array.count();
+    } else {
+        // 数组逐个探测位图
+        const Container& sparse = a.words.isEmpty() ? a : b;
+        const Container& dense = a.words.isEmpty() ? b : a;
+        for (quint16 low : sparse.array) {
+            if (containerContains(dense, low)) result.array.append(low);
+        }
+        result.cardinality = result.array.count();
+    }
+    return result;
+}
+
+TaskBitmap::Container TaskBitmap::unite(const Container& a, const Container& b)
+{
+    Container result;
+    if (a.words.isEmpty() && b.words.isEmpty()) {
+        std::set_union(a.array.constBegin(), a.array.constEnd(), b.array.constBegin(), b.array.constEnd(),
+                       std::back_inserter(result.array));
+        result.cardinality = result.array.count();
+        if (result.cardinality > kArrayMaxSize) toWords(result);
+        return result;
+    }
+
+    result = a;
+    toWords(result);
+    Container other = b;
+    toWords(other);
+    result.cardinality = 0;
+    for (int i = 0; i < kWordCount; ++i) {
+        result.words[i] |= other.words.at(i);
+        result.cardinality += qPopulationCount(result.words.at(i));
+    }
+    return result;
+}
+
+TaskBitmap::Container TaskBitmap::subtract(const Container& a, const Container& b)
+{
+    Container result;
+    if (!a.words.isEmpty()) {
+        result = a;
+        Container other = b;
+        toWords(other);
+        result.cardinality = 0;
+        for (int i = 0; i < kWordCount; ++i) {
+            result.words[i] &= ~other.words.at(i);
+            result.cardinality += qPopulationCount(result.words.at(i));
+        }
+        toArrayIfSparse(result);
+        return result;
+    }
+    for (quint16 low : a.array) {
+        if (!containerContains(b, low)) result.array.append(low);
+    }
+    result.cardinality = result.array.count();
+    return result;
+}
+
+int TaskBitmap::intersectCount(const Container& a, const Container& b)
+{
+    int count = 0;
+    if (!a.words.isEmpty() && !b.words.isEmpty()) {
+        for (int i = 0; i < kWordCount; ++i) {
+            count += qPopulationCount(a.words.at(i) & b.words.at(i));
+        }
+        return count;
+    }
+    const Container& sparse = a.words.isEmpty() ? a : b;
+    const Container& other = a.words.isEmpty() ? b : a;
+    for (quint16 low : sparse.array) {
+        if (containerContains(other, low)) ++count;
+    }
+    return count;
+}
+
+TaskBitmap TaskBitmap::operator&(const TaskBitmap& other) const
+{
+    TaskBitmap result;
+    // 只需处理两边都有的块：遍历块数较少的一边
+    const bool thisSmaller = m_containers.count() <= other.m_containers.count();
+    const TaskBitmap& small = thisSmaller ? *this : other;
+    const TaskBitmap& large = thisSmaller ? other : *this;
+    for (QMap<int, Container>::const_iterator it = small.m_containers.constBegin(); it != small.m_containers.constEnd(); ++it) {
+        QMap<int, Container>::const_iterator found = large.m_containers.constFind(it.key());
+        if (found == large.m_containers.constEnd()) continue;
+        Container container = intersect(it.value(), found.value());
+        if (container.cardinality > 0) result.m_containers.insert(it.key(), container);
+    }
+    return result;
+}
+
+TaskBitmap TaskBitmap::operator|(const TaskBitmap& other) const
+{
+    TaskBitmap result = *this;
+    for (QMap<int, Container>::const_iterator it = other.m_containers.constBegin(); it != other.m_containers.constEnd(); ++it) {
+        QMap<int, Container>::iterator found = result.m_containers.find(it.key());
+        if (found == result.m_containers.end()) {
+            result.m_containers.insert(it.key(), it.value());
+        } else {
+            found.value() = unite(found.value(), it.value());
+        }
+    }
+    return result;
+}
+
+TaskBitmap TaskBitmap::andNot(const TaskBitmap& other) const
+{
+    TaskBitmap result;
+    for (QMap<int, Container>::const_iterator it = m_containers.constBegin(); it != m_containers.constEnd(); ++it) {
+        QMap<int, Container>::const_iterator found = other.m_containers.constFind(it.key());
+        if (found == other.m_containers.constEnd()) {
+            result.m_containers.insert(it.key(), it.value());
+            continue;
+        }
+        Container container = subtract(it.value(), found.value());
+        if (container.cardinality > 0) result.m_containers.insert(it.key(), container);
+    }
+    return result;
+}
+
+int TaskBitmap::intersectionCount(const TaskBitmap& other) const
+{
+    int count = 0;
+    for (QMap<int, Container>::const_iterator it = m_containers.constBegin(); it != m_containers.constEnd(); ++it) {
+        QMap<int, Container>::const_iterator found = other.m_containers.constFind(it.key());
+        if (found != other.m_containers.constEnd()) {
+            count += intersectCount(it.value(), found.value());
+        }
+    }
+    return count;
+}
+
+bool TaskBitmap::forEachDescending(const std::function<bool(int)>& visitor, int below) const
+{
+    if (below <= 0) return true;
+    const int lastValue = below - 1;
+    // 从lastValue所在块开始（upperBound后退一步即不大于该高位的最后一块）
+    QMap<int, Container>::const_iterator it = m_containers.upperBound(lastValue >> 16);
+    while (it != m_containers.constBegin()) {
+        --it;
+        const int high = it.key() << 16;
+        const Container& container = it.value();
+        const bool boundary = it.key() == (lastValue >> 16); // 只有边界块需要跳过不小于below的值
+        const quint16 lastLow = boundary ? quint16(lastValue & 0xFFFF) : quint16(0xFFFF);
+        if (container.words.isEmpty()) {
+            const int end = int(std::upper_bound(container.array.constBegin(), container.array.constEnd(), lastLow)
+                                - container.array.constBegin());
+            for (int i = end - 1; i >= 0; --i) {
+                if (!visitor(high | container.array.at(i))) return false;
+            }
+            continue;
+        }
+        for (int word = lastLow >> 6; word >= 0; --word) {
+            quint64 bits = container.words.at(word);
+            if (word == (lastLow >> 6) && (lastLow & 63) != 63) {
+                bits &= (quint64(1) << ((lastLow & 63) + 1)) - 1;
+            }
+            while (bits) {
+                const int bit = 63 - qCountLeadingZeroBits(bits);
+                if (!visitor(high | (word << 6) | bit)) return false;
+                bits &= ~(quint64(1) << bit);
+            }
+        }
+    }
+    return true;
+}
+
+QVector<int> TaskBitmap::toDescendingVector() const
+{
+    QVector<int> values;
+    values.reserve(count());
+    forEachDescending([&](int value) -> bool {
+        values.append(value);
+        return true;
+    });
+    return values;
+}
+
+int TaskBitmap::countAbove(int value) const
+{
+    int total = 0;
+    const int high = value >> 16;
+    const quint16 low = quint16(value & 0xFFFF);
+    for (QMap<int, Container>::const_iterator it = m_containers.upperBound(high); it != m_containers.constEnd(); ++it) {
+        total += it.value().cardinality;
+    }
+    QMap<int, Container>::const_iterator found = m_containers.constFind(high);
+    if (found == m_containers.constEnd()) return total;
+
+    const Container& container = found.value();
+    if (container.words.isEmpty()) {
+        return total + int(container.array.constEnd()
+                           - std::upper_bound(container.array.constBegin(), container.array.constEnd(), low));
+    }
+    // 所在字只计高于low的位（low为字内最高位时掩码为0）
+    const int word = low >> 6;
+    total += qPopulationCount(container.words.at(word) & ~((quint64(2) << (low & 63)) - 1));
+    for (int i = word + 1; i < kWordCount; ++i) {
+        total += qPopulationCount(container.words.at(i));
+    }
+    return total;
+}
+
+int TaskBitmap::valueAtDescending(int rank) const
+{
+    if (rank < 0) return -1;
+    QMap<int, Container>::const_iterator it = m_containers.constEnd();
+    while (it != m_containers.constBegin()) {
+        --it;
+        const Container& container = it.value();
+        if (rank >= container.cardinality) {
+            rank -= container.cardinality;
+            continue;
+        }
+        const int high = it.key() << 16;
+        if (container.words.isEmpty()) return high | container.array.at(container.cardinality - 1 - rank);
+        for (int word = kWordCount - 1; word >= 0; --word) {
+            quint64 bits = container.words.at(word);
+            const int bitCount = qPopulationCount(bits);
+            if (rank >= bitCount) {
+                rank -= bitCount;
+                continue;
+            }
+            // 去掉字内最高的rank个位，剩下的最高位即所求
+            for (; rank > 0; --rank) {
+                bits &= ~(quint64(1) << (63 - qCountLeadingZeroBits(bits)));
+            }
+            return high | (word << 6) | (63 - qCountLeadingZeroBits(bits));
+        }
+    }
+    return -1;
+}
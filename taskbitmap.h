@@ -0,0 +1,57 @@
+#ifndef TASKBITMAP_H
+#define TASKBITMAP_H
+
+#include <QMap>
+#include <QVector>
+#include <climits>
+#include <functional>
+
+// 压缩位图（任务ID集合）：按高16位分块，每块元素少时存为有序数组，多时存为1024个64位字的位图
+// 稀疏集合（如某个标签）只占少量内存，稠密集合（如某个分类）的交集按字做位与
+class TaskBitmap
+{
+public:
+    TaskBitmap() = default;
+
+    void add(int value);
+    void remove(int value);
+    bool contains(int value) const;
+    int count() const;
+    bool isEmpty() const;
+    void clear();
+
+    TaskBitmap operator&(const TaskBitmap& other) const; // 交集
+    TaskBitmap operator|(const TaskBitmap& other) const; // 并集
+    TaskBitmap andNot(const TaskBitmap& other) const; // 差集
+    int intersectionCount(const TaskBitmap& other) const; // 交集大小（不构造交集）
+
+    // 从大到小依次回调小于below的值（任务ID倒序），visitor返回false时停止；返回值为是否完整遍历
+    // below用于分页：从上一页最后一个ID之后继续
+    bool forEachDescending(const std::function<bool(int)>& visitor, int below = INT_MAX) const;
+    QVector<int> toDescendingVector() const;
+    // 按倒序位置换算：大于value的值的个数（ID -> 行号），倒序第rank个值（行号 -> ID，越界返回-1）
+    // 按块基数跳过整块，位图块内按字计数，不逐个遍历
+    int countAbove(int value) const;
+    int valueAtDescending(int rank) const;
+
+private:
+    struct Container {
+        QVector<quint16> array; // 稀疏块：升序的低16位
+        QVector<quint64> words; // 稠密块：位图（非空即表示位图形式）
+        int cardinality = 0;
+    };
+    static const int kArrayMaxSize = 4096; // 超过即转为位图（此时两种形式占用相同）
+    static const int kWordCount = 1024; // 65536位
+
+    static void toWords(Container& container);
+    static void toArrayIfSparse(Container& container);
+    static bool containerContains(const Container& container, quint16 low);
+    static Container intersect(const Container& a, const Container& b);
+    static Container unite(const Container& a, const Container& b);
+    static Container subtract(const Container& a, const Container& b);
+    static int intersectCount(const Container& a, const Container& b);
+
+    QMap<int, Container> m_containers; // 高16位 -> 块（空块不保存）
+};
+
+#endif // TASKBITMAP_H
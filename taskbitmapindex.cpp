@@ -0,0 +1,215 @@
+#include "taskbitmapindex.h"
+
+void TaskBitmapIndex::build(const QList<Task>& activeTasks, const QHash<int, QStringList>& tags, qint64 nowMs)
+{
+    m_active.clear();
+    for (TaskBitmap& bitmap : m_category) bitmap.clear();
+    for (TaskBitmap& bitmap : m_priority) bitmap.clear();
+    m_completed.clear();
+    m_overdue.clear();
+    m_tags.clear();
+    m_deadlines.clear();
+
+    for (const Task& task : activeTasks) {
+        addTask(task, nowMs);
+    }
+    for (QHash<int, QStringList>::const_iterator it = tags.constBegin(); it != tags.constEnd(); ++it) {
+        for (const QString& tag : it.value()) {
+            m_tags[tag].add(it.key());
+        }
+    }
+    m_built = true;
+}
+
+bool TaskBitmapIndex::isBuilt() const
+{
+    return m_built;
+}
+
+void TaskBitmapIndex::addTask(const Task& task, qint64 nowMs)
+{
+    if (task.is_archived || task.id <= 0) return;
+
+    m_active.add(task.id);
+    m_category[qMin<int>(task.category, CategoryCount - 1)].add(task.id);
+    m_priority[qMin<int>(task.priority, PriorityCount - 1)].add(task.id);
+    if (task.status == StatusCompleted) {
+        m_completed.add(task.id);
+        return;
+    }
+
+    // 无截止时间的任务不计为超期
+    if (!task.dueTime.isValid()) return;
+    const qint64 dueMs = task.dueTime.toMSecsSinceEpoch();
+    if (dueMs < nowMs) {
+        m_overdue.add(task.id);
+    } else {
+        m_deadlines.schedule(task.id, dueMs);
+    }
+}
+
+void TaskBitmapIndex::removeTask(int taskId)
+{
+    m_active.remove(taskId);
+    for (TaskBitmap& bitmap : m_category) bitmap.remove(taskId);
+    for (TaskBitmap& bitmap : m_priority) bitmap.remove(taskId);
+    m_completed.remove(taskId);
+    m_overdue.remove(taskId);
+    m_deadlines.cancel(taskId);
+}
+
+void TaskBitmapIndex::removeTaskTags(int taskId)
+{
+    QHash<QString, TaskBitmap>::iterator it = m_tags.begin();
+    while (it != m_tags.end()) {
+        it.value().remove(taskId);
+        if (it.value().isEmpty()) {
+            it = m_tags.erase(it);
+        } else {
+            ++it;
+        }
+    }
+}
+
+void TaskBitmapIndex::applyChanges(const QList<TaskChange>& changes, qint64 nowMs)
+{
+    if (!m_built) return;
+
+    for (const TaskChange& change : changes) {
+        switch (change.type) {
+        case TaskChange::Deleted:
+            removeTask(change.taskId);
+            removeTaskTags(change.taskId);
+            break;
+        case TaskChange::TagsChanged:
+            removeTaskTags(change.taskId);
+            for (const QString& tag : change.tags) {
+                m_tags[tag].add(change.taskId);
+            }
+            break;
+        case TaskChange::Inserted:
+        case TaskChange::Updated:
+        case TaskChange::Archived:
+        case TaskChange::Restored:
+            // 标签不随归档变化，只更新任务自身的分面
+            removeTask(change.taskId);
+            if (change.task.isValid()) addTask(change.task, nowMs);
+            break;
+        }
+    }
+}
+
+QVector<int> TaskBitmapIndex::advanceClock(qint64 nowMs)
+{
+    // 超期为截止时间严格早于当前时间；任务已完成、删除或截止时间已修改的条目已作废，不会取出
+    const QVector<int> crossed = m_deadlines.takeUntil(nowMs - 1);
+    for (int taskId : crossed) {
+        m_overdue.add(taskId);
+    }
+    return crossed;
+}
+
+qint64 TaskBitmapIndex::nextDeadline()
+{
+    return m_deadlines.nextDeadline();
+}
+
+bool TaskBitmapIndex::isOverdue(int taskId) const
+{
+    return m_overdue.contains(taskId);
+}
+
+TaskBitmap TaskBitmapIndex::filter(const TaskQuery& query, Facet skipFacet) const
+{
+    TaskBitmap result = m_active;
+    if (skipFacet != CategoryFacet && query.m_category >= 0) {
+        result = result & m_category[qMin(query.m_category, CategoryCount - 1)];
+    }
+    if (skipFacet != PriorityFacet && query.m_priority >= 0) {
+        result = result & m_priority[qMin(query.m_priority, PriorityCount - 1)];
+    }
+    if (skipFacet != StatusFacet) {
+        switch (query.m_status) {
+        case TaskQuery::Uncompleted:
+            result = result.andNot(m_completed).andNot(m_overdue);
+            break;
+        case TaskQuery::Completed:
+            result = result & m_completed;
+            break;
+        case TaskQuery::Overdue:
+            result = result & m_overdue;
+            break;
+        case TaskQuery::AnyStatus:
+            break;
+        }
+    }
+    if (skipFacet != TagFacet && !query.m_tag.isEmpty()) {
+        result = result & m_tags.value(query.m_tag);
+    }
+    return result;
+}
+
+TaskBitmap TaskBitmapIndex::evaluate(const TaskQuery& query) const
+{
+    return filter(query, NoFacet);
+}
+
+bool TaskBitmapIndex::matches(int taskId, const TaskQuery& query) const
+{
+    if (!m_active.contains(taskId)) return false;
+    if (query.m_category >= 0 && !m_category[qMin(query.m_category, CategoryCount - 1)].contains(taskId)) return false;
+    if (query.m_priority >= 0 && !m_priority[qMin(query.m_priority, PriorityCount - 1)].contains(taskId)) return false;
+
+    switch (query.m_status) {
+    case TaskQuery::Uncompleted:
+        if (m_completed.contains(taskId) || m_overdue.contains(taskId)) return false;
+        break;
+    case TaskQuery::Completed:
+        if (!m_completed.contains(taskId)) return false;
+        break;
+    case TaskQuery::Overdue:
+        if (!m_overdue.contains(taskId)) return false;
+        break;
+    case TaskQuery::AnyStatus:
+        break;
+    }
+
+    if (!query.m_tag.isEmpty()) {
+        QHash<QString, TaskBitmap>::const_iterator it = m_tags.constFind(query.m_tag);
+        if (it == m_tags.constEnd() || !it.value().contains(taskId)) return false;
+    }
+    return true;
+}
+
+TaskBitmapIndex::FacetCounts TaskBitmapIndex::facetCounts(const TaskQuery& query) const
+{
+    FacetCounts counts;
+    counts.total = evaluate(query).count();
+
+    const TaskBitmap withoutCategory = filter(query, CategoryFacet);
+    counts.categoryAll = withoutCategory.count();
+    for (int i = 0; i < CategoryCount; ++i) {
+        counts.category[i] = withoutCategory.intersectionCount(m_category[i]);
+    }
+
+    const TaskBitmap withoutPriority = filter(query, PriorityFacet);
+    counts.priorityAll = withoutPriority.count();
+    for (int i = 0; i < PriorityCount; ++i) {
+        counts.priority[i] = withoutPriority.intersectionCount(m_priority[i]);
+    }
+
+    // 已完成与超期互斥，其余即为未超期的未完成任务
+    const TaskBitmap withoutStatus = filter(query, StatusFacet);
+    counts.statusAll = withoutStatus.count();
+    counts.status[StatusFacetCompleted] = withoutStatus.intersectionCount(m_completed);
+    counts.status[StatusFacetOverdue] = withoutStatus.intersectionCount(m_overdue);
+    counts.status[StatusFacetUncompleted] = counts.statusAll - counts.status[StatusFacetCompleted]
+                                            - counts.status[StatusFacetOverdue];
+
+    const TaskBitmap withoutTag = filter(query, TagFacet);
+    counts.tagAll = withoutTag.count();
+    for (QHash<QString, TaskBitmap>::const_iterator it = m_tags.constBegin(); it != m_tags.constEnd(); ++it) {
+        counts.tags.insert(it.key(), withoutTag.intersectionCount(it.value()));
+    }
+    return counts;
+}
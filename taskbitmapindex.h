@@ -0,0 +1,77 @@
+#ifndef TASKBITMAPINDEX_H
+#define TASKBITMAPINDEX_H
+
+#include <QHash>
+#include <QList>
+#include <QString>
+#include <QStringList>
+#include <QVector>
+#include "task.h"
+#include "taskbitmap.h"
+#include "deadlinequeue.h"
+#include "taskquery.h"
+#include "taskchangenotifier.h"
+
+// 未归档任务的分面位图索引：每个分类、优先级、状态、标签取值对应一个按任务ID置位的压缩位图
+// 筛选为位图的与/差运算，各下拉选项的计数为交集大小；由变更通知就地维护，不重新扫描任务
+class TaskBitmapIndex
+{
+public:
+    // 状态分面（与界面状态下拉框一致）
+    enum StatusFacet {
+        StatusFacetUncompleted, // 未完成且未超期
+        StatusFacetCompleted,
+        StatusFacetOverdue,
+        StatusFacetCount
+    };
+
+    // 各下拉选项的计数：某一分面的计数按其余分面的当前条件计算，即选中该项后的结果行数
+    struct FacetCounts {
+        int total = 0; // 满足全部条件的任务数
+        int categoryAll = 0;
+        int category[CategoryCount] = {};
+        int priorityAll = 0;
+        int priority[PriorityCount] = {};
+        int statusAll = 0;
+        int status[StatusFacetCount] = {};
+        int tagAll = 0;
+        QHash<QString, int> tags; // 标签名（区分大小写）-> 计数
+    };
+
+    TaskBitmapIndex() = default;
+
+    // 全量构建：activeTasks为未归档任务，tags为全部任务（含已归档）的标签
+    void build(const QList<Task>& activeTasks, const QHash<int, QStringList>& tags, qint64 nowMs);
+    bool isBuilt() const;
+    void applyChanges(const QList<TaskChange>& changes, qint64 nowMs);
+
+    // 推进时钟：截止时间已过的未完成任务转入超期集合，返回本次转入的任务ID
+    QVector<int> advanceClock(qint64 nowMs);
+    // 最近一个尚未到达的截止时间（毫秒，没有时返回-1），用于安排下一次advanceClock()
+    qint64 nextDeadline();
+    bool isOverdue(int taskId) const; // 未完成且已过截止时间（以最近一次推进时钟为准）
+
+    // 只使用分类、优先级、状态与标签条件（关键词与归档查询由数据库处理）
+    TaskBitmap evaluate(const TaskQuery& query) const;
+    bool matches(int taskId, const TaskQuery& query) const;
+    FacetCounts facetCounts(const TaskQuery& query) const;
+
+private:
+    enum Facet { NoFacet, CategoryFacet, PriorityFacet, StatusFacet, TagFacet };
+
+    TaskBitmap filter(const TaskQuery& query, Facet skipFacet) const; // 跳过指定分面的条件
+    void addTask(const Task& task, qint64 nowMs);
+    void removeTask(int taskId);
+    void removeTaskTags(int taskId);
+
+    bool m_built = false;
+    TaskBitmap m_active; // 全部未归档任务
+    TaskBitmap m_category[CategoryCount];
+    TaskBitmap m_priority[PriorityCount];
+    TaskBitmap m_completed;
+    TaskBitmap m_overdue; // 未完成且已过截止时间
+    QHash<QString, TaskBitmap> m_tags; // 标签名（区分大小写）-> 任务（含已归档，使用时与m_active求交）
+    DeadlineQueue m_deadlines; // 未超期的未完成任务 -> 截止时间
+};
+
+#endif // TASKBITMAPINDEX_H
@@ -0,0 +1,9 @@
+#include "taskchangenotifier.h"
+
+TaskChangeNotifier::TaskChangeNotifier(QObject *parent)
+    : QObject(parent)
+{
+    // 队列连接需要按名称找到参数类型
+    qRegisterMetaType<TaskChange>("TaskChange");
+    qRegisterMetaType<QList<TaskChange>>("QList<TaskChange>");
+}
@@ -0,0 +1,40 @@
+#ifndef TASKCHANGENOTIFIER_H
+#define TASKCHANGENOTIFIER_H
+
+#include <QObject>
+#include <QList>
+#include <QStringList>
+#include <QMetaType>
+#include "task.h"
+
+// 单个任务的行级变更（写入提交成功后由DatabaseManager发出）
+struct TaskChange {
+    enum Type {
+        Inserted,   // 新增任务
+        Updated,    // 任务字段被修改
+        Deleted,    // 任务被删除（含永久删除归档任务）
+        Archived,   // 任务被归档
+        Restored,   // 任务从归档恢复
+        TagsChanged // 任务标签被替换
+    };
+
+    Type type = Updated;
+    int taskId = -1;
+    Task task; // 变更后的任务（Deleted时为空）
+    QStringList tags; // 变更后的标签（仅TagsChanged）
+};
+Q_DECLARE_METATYPE(TaskChange)
+
+// 任务变更通知（DatabaseManager不是QObject，由它持有本对象转发信号）
+// 一次写操作的全部变更在一个信号中发出；跨线程写入时接收方按队列连接在自身线程处理
+class TaskChangeNotifier : public QObject
+{
+    Q_OBJECT
+public:
+    explicit TaskChangeNotifier(QObject *parent = nullptr);
+
+signals:
+    void tasksChanged(const QList<TaskChange>& changes);
+};
+
+#endif // TASKCHANGENOTIFIER_H
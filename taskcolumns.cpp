@@ -0,0 +1,134 @@
+#include "taskcolumns.h"
+#include <QPair>
+#include <QThread>
+#include <QtConcurrent>
+#include <algorithm>
+
+namespace {
+// 每块至少的行数：行数较少时线程调度开销大于收益，直接单线程计算
+const int kMinRowsPerChunk = 64 * 1024;
+
+// 单块聚合：块内按时间节点切成若干连续段，每段内只做顺序累加
+TaskColumnReport reduceRows(const TaskColumns& columns, int begin, int end,
+                            const QVector<qint64>& edges, qint64 nowMs)
+{
+    TaskColumnReport report;
+    report.total = end - begin;
+    report.bucketTotals.fill(0, edges.count());
+    report.bucketCompleted.fill(0, edges.count());
+
+    const qint64* due = columns.dueMs.constData();
+    const quint8* status = columns.status.constData();
+    const quint8* category = columns.category.constData();
+
+    int segmentBegin = begin;
+    for (int bucket = 0; bucket <= edges.count(); ++bucket) {
+        // 截止时间不晚于该节点的行构成本段（最后一段为晚于所有节点的行）
+        const int segmentEnd = (bucket < edges.count())
+                                   ? int(std::upper_bound(due + segmentBegin, due + end, edges.at(bucket)) - due)
+                                   : end;
+        int completed = 0;
+        int overdue = 0;
+        for (int i = segmentBegin; i < segmentEnd; ++i) {
+            const int done = status[i] == StatusCompleted;
+            completed += done;
+            overdue += (1 - done) & int(due[i] < nowMs);
+            ++report.byCategory[category[i]];
+        }
+        report.completed += completed;
+        report.overdue += overdue;
+        if (bucket < edges.count()) {
+            report.bucketTotals[bucket] = segmentEnd - segmentBegin;
+            report.bucketCompleted[bucket] = completed;
+        }
+        segmentBegin = segmentEnd;
+    }
+    return report;
+}
+}
+
+TaskColumns TaskColumns::fromTasks(const QList<Task>& tasks, quint64 version)
+{
+    // 先按截止时间排序下标，再按排序结果逐列填充
+    QVector<QPair<qint64, int>> order;
+    order.reserve(tasks.count());
+    for (int i = 0; i < tasks.count(); ++i) {
+        const QDateTime& dueTime = tasks.at(i).dueTime;
+        order.append(qMakePair(dueTime.isValid() ? dueTime.toMSecsSinceEpoch() : qint64(0), i));
+    }
+    std::sort(order.begin(), order.end());
+
+    TaskColumns columns;
+    columns.version = version;
+    columns.dueMs.reserve(order.count());
+    columns.status.reserve(order.count());
+    columns.category.reserve(order.count());
+    for (const QPair<qint64, int>& entry : order) {
+        const Task& task = tasks.at(entry.second);
+        columns.dueMs.append(entry.first);
+        columns.status.append(task.status == StatusCompleted ? StatusCompleted : StatusUncompleted);
+        // 枚举值在此处收敛到合法范围，聚合时可直接作为下标
+        columns.category.append(qMin<int>(task.category, CategoryCount - 1));
+    }
+    return columns;
+}
+
+void TaskColumns::dueRange(qint64 fromMs, qint64 toMs, int* first, int* last) const
+{
+    *first = int(std::lower_bound(dueMs.constBegin(), dueMs.constEnd(), fromMs) - dueMs.constBegin());
+    *last = int(std::upper_bound(dueMs.constBegin(), dueMs.constEnd(), toMs) - dueMs.constBegin());
+    if (*last < *first) *last = *first;
+}
+
+double TaskColumnReport::completionRate() const
+{
+    return total > 0 ? (static_cast<double>(completed) / total) * 100 : 0.0;
+}
+
+void TaskColumnReport::merge(const TaskColumnReport& other)
+{
+    total += other.total;
+    completed += other.completed;
+    overdue += other.overdue;
+    for (int i = 0; i < CategoryCount; ++i) byCategory[i] += other.byCategory[i];
+
+    if (bucketTotals.isEmpty()) {
+        bucketTotals.fill(0, other.bucketTotals.count());
+        bucketCompleted.fill(0, other.bucketCompleted.count());
+    }
+    for (int i = 0; i < other.bucketTotals.count() && i < bucketTotals.count(); ++i) {
+        bucketTotals[i] += other.bucketTotals.at(i);
+        bucketCompleted[i] += other.bucketCompleted.at(i);
+    }
+}
+
+TaskColumnReport TaskColumnReport::reduce(const TaskColumns& columns, qint64 fromMs, qint64 toMs,
+                                          const QVector<qint64>& bucketEdgesMs, qint64 nowMs)
+{
+    int first = 0;
+    int last = 0;
+    columns.dueRange(fromMs, toMs, &first, &last);
+
+    const int rows = last - first;
+    const int chunkCount = qBound(1, rows / kMinRowsPerChunk, QThread::idealThreadCount());
+    if (chunkCount == 1) {
+        return reduceRows(columns, first, last, bucketEdgesMs, nowMs);
+    }
+
+    // 按行均分为若干连续块，各块在线程池中独立聚合后合并（合并满足交换律，顺序无关）
+    QVector<QPair<int, int>> chunks;
+    for (int i = 0; i < chunkCount; ++i) {
+        chunks.append(qMakePair(first + int(qint64(rows) * i / chunkCount),
+                                first + int(qint64(rows) * (i + 1) / chunkCount)));
+    }
+    TaskColumnReport report = QtConcurrent::blockingMappedReduced<TaskColumnReport>(
+        chunks,
+        [&](const QPair<int, int>& chunk) {
+            return reduceRows(columns, chunk.first, chunk.second, bucketEdgesMs, nowMs);
+        },
+        [](TaskColumnReport& result, const TaskColumnReport& part) {
+            result.merge(part);
+        },
+        QtConcurrent::UnorderedReduce);
+    return report;
+}
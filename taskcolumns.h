@@ -0,0 +1,43 @@
+#ifndef TASKCOLUMNS_H
+#define TASKCOLUMNS_H
+
+#include <QVector>
+#include <QList>
+#include <QSharedPointer>
+#include "task.h"
+
+// 列式任务数据（结构数组）：各字段分别存放在连续数组中，统计时只读取用到的列
+// 按截止时间升序排列，时间范围可二分定位，范围内的行连续
+struct TaskColumns {
+    quint64 version = 0; // 来源快照的版本号
+    QVector<qint64> dueMs; // 截止时间（毫秒时间戳）
+    QVector<quint8> status;
+    QVector<quint8> category;
+
+    int count() const { return dueMs.count(); }
+    static TaskColumns fromTasks(const QList<Task>& tasks, quint64 version);
+    // 截止时间在[fromMs, toMs]内的行区间[*first, *last)
+    void dueRange(qint64 fromMs, qint64 toMs, int* first, int* last) const;
+};
+typedef QSharedPointer<const TaskColumns> TaskColumnsPtr;
+
+// 列式聚合结果
+struct TaskColumnReport {
+    int total = 0;
+    int completed = 0;
+    int overdue = 0; // 未完成且已过截止时间
+    int byCategory[CategoryCount] = {};
+    // 按时间节点分桶：任务计入第一个不早于其截止时间的节点（晚于最后一个节点的不计入）
+    QVector<int> bucketTotals;
+    QVector<int> bucketCompleted;
+
+    double completionRate() const; // 完成率（百分比）
+    void merge(const TaskColumnReport& other);
+
+    // 聚合截止时间在[fromMs, toMs]内的任务；bucketEdgesMs为升序的时间节点
+    // 行数较多时按CPU核数分块并行计算，再合并各块结果
+    static TaskColumnReport reduce(const TaskColumns& columns, qint64 fromMs, qint64 toMs,
+                                   const QVector<qint64>& bucketEdgesMs, qint64 nowMs);
+};
+
+#endif // TASKCOLUMNS_H
@@ -0,0 +1,133 @@
+#include "taskpager.h"
+#include "databasemanager.h"
+#include <algorithm>
+#include <climits>
+
+namespace {
+// 第一页也带上ID上界：有统计信息时，规划器对"is_archived = ? AND id < ? ORDER BY id DESC LIMIT"
+// 选用主键倒序扫描；不带上界时仍会按(is_archived, ...)索引取出全部匹配行再排序
+int pageUpperBound(int beforeId)
+{
+    return beforeId > 0 ? beforeId : INT_MAX;
+}
+}
+
+TaskPager::TaskPager(int pageSize, int maxResidentPages)
+    : m_pageSize(qMax(1, pageSize))
+    , m_exhausted(false)
+    , m_rowCount(0)
+{
+    m_resident.setMaxCost(qMax(1, maxResidentPages));
+    m_residentTags.setMaxCost(qMax(1, maxResidentPages));
+}
+
+void TaskPager::reset(const TaskQuery& query)
+{
+    m_query = query;
+    m_exhausted = false;
+    m_pages.clear();
+    m_pageStarts.clear();
+    m_rowCount = 0;
+    m_resident.clear();
+    m_residentTags.clear();
+}
+
+const TaskQuery& TaskPager::query() const
+{
+    return m_query;
+}
+
+bool TaskPager::canFetchMore() const
+{
+    return !m_exhausted;
+}
+
+QList<Task> TaskPager::loadNextPage() const
+{
+    if (m_exhausted) return QList<Task>();
+
+    // 键集分页：从上一页最小ID之下继续取，不使用OFFSET，取第N页与取第1页代价相同
+    const int beforeId = m_pages.isEmpty() ? 0 : m_pages.last().minId;
+    return DatabaseManager::instance().queryTasks(TaskQuery(m_query).idRange(0, pageUpperBound(beforeId)).limit(m_pageSize));
+}
+
+void TaskPager::appendPage(const QList<Task>& tasks)
+{
+    if (m_exhausted) return;
+
+    const int beforeId = m_pages.isEmpty() ? 0 : m_pages.last().minId;
+    m_exhausted = tasks.count() < m_pageSize;
+
+    if (tasks.isEmpty()) return;
+
+    Page page;
+    page.beforeId = beforeId;
+    page.minId = m_exhausted ? 0 : tasks.last().id;
+    page.rowCount = tasks.count();
+    m_pages.append(page);
+    m_pageStarts.append(m_rowCount);
+    m_rowCount += tasks.count();
+    m_resident.insert(m_pages.count() - 1, new QList<Task>(tasks));
+}
+
+int TaskPager::rowCount() const
+{
+    return m_rowCount;
+}
+
+int TaskPager::pageOfRow(int row) const
+{
+    // 各页都不为空：第一个起始行大于row的页的前一页即所在页
+    QVector<int>::const_iterator it = std::upper_bound(m_pageStarts.constBegin(), m_pageStarts.constEnd(), row);
+    return int(it - m_pageStarts.constBegin()) - 1;
+}
+
+QList<Task>* TaskPager::residentPage(int page) const
+{
+    QList<Task>* tasks = m_resident.object(page);
+    if (tasks) return tasks;
+
+    // 按ID区间重新查询，再截取或补齐到原行数：其他页的行号保持不变；
+    // 取页之后本页已被删除的行使其后的行在页内前移，页尾以空任务（ID为-1）补齐
+    const Page& info = m_pages.at(page);
+    tasks = new QList<Task>(DatabaseManager::instance().queryTasks(
+        TaskQuery(m_query).idRange(info.minId, pageUpperBound(info.beforeId)).limit(info.rowCount)));
+    while (tasks->count() < info.rowCount) {
+        tasks->append(Task());
+    }
+    m_resident.insert(page, tasks);
+    return tasks;
+}
+
+const QHash<int, QStringList>* TaskPager::residentTags(int page) const
+{
+    QHash<int, QStringList>* tags = m_residentTags.object(page);
+    if (tags) return tags;
+
+    // 任务ID取自页内容（不在缓存中时随之重新装入）
+    QVector<int> taskIds;
+    for (const Task& task : *residentPage(page)) {
+        if (task.id > 0) taskIds.append(task.id);
+    }
+    tags = new QHash<int, QStringList>(DatabaseManager::instance().getTagsForTasks(taskIds));
+    m_residentTags.insert(page, tags);
+    return tags;
+}
+
+QStringList TaskPager::tagsAt(int row) const
+{
+    if (row < 0 || row >= m_rowCount) return QStringList();
+
+    const int page = pageOfRow(row);
+    const QHash<int, QStringList>* tags = residentTags(page);
+    return tags->value(residentPage(page)->at(row - m_pageStarts.at(page)).id);
+}
+
+const Task* TaskPager::taskAt(int row) const
+{
+    if (row < 0 || row >= m_rowCount) return nullptr;
+
+    const int page = pageOfRow(row);
+    const QList<Task>* tasks = residentPage(page);
+    return &tasks->at(row - m_pageStarts.at(page));
+}
@@ -0,0 +1,59 @@
+#ifndef TASKPAGER_H
+#define TASKPAGER_H
+
+#include <QList>
+#include <QVector>
+#include <QCache>
+#include <QHash>
+#include <QStringList>
+#include "task.h"
+#include "taskquery.h"
+
+// 按ID倒序的键集分页器：表格滚动到末尾时再向数据库取下一页，
+// 已取过的页只常驻键集游标（ID区间与行数，每页12字节，与页内行数无关），任务ID与完整任务只在有容量上限的LRU缓存中，
+// 即最近访问（可见区附近）的若干页；被淘汰的页再次访问时按ID区间重新查询
+class TaskPager
+{
+public:
+    explicit TaskPager(int pageSize = 256, int maxResidentPages = 16);
+
+    // 更换查询条件并清空已取的页（不立即查询）
+    void reset(const TaskQuery& query);
+    const TaskQuery& query() const;
+
+    bool canFetchMore() const;
+    // 取下一页分两步：先查询，再追加（模型在两步之间发出beginInsertRows）
+    QList<Task> loadNextPage() const;
+    void appendPage(const QList<Task>& tasks); // 不足一页即表示已取完
+    int rowCount() const;
+
+    // 指定行的任务（所在页已被淘汰时重新装入）；越界返回nullptr
+    // 返回的指针在下一次访问其他页之前有效
+    const Task* taskAt(int row) const;
+    // 指定行任务的标签：所在页的标签用一条查询一次装入，与任务内容一样放在LRU缓存中
+    QStringList tagsAt(int row) const;
+
+private:
+    // 每页覆盖一段连续的ID区间[minId, beforeId)，各页区间首尾相接
+    // 已取的行数固定不变（数据变化后由调用方reset()），重新装入时截取或补齐到原行数
+    struct Page {
+        int minId;
+        int beforeId; // 0为不限（第一页）
+        int rowCount;
+    };
+
+    int pageOfRow(int row) const;
+    QList<Task>* residentPage(int page) const; // 取页内容，不在缓存中则按ID区间查询
+    const QHash<int, QStringList>* residentTags(int page) const; // 取页内各任务的标签，不在缓存中则按页内任务ID查询
+
+    TaskQuery m_query;
+    int m_pageSize;
+    bool m_exhausted; // 已取到最后一页
+    QVector<Page> m_pages;
+    QVector<int> m_pageStarts; // 每页第一行的行号
+    int m_rowCount;
+    mutable QCache<int, QList<Task>> m_resident; // 页号 -> 页内容（LRU，行数与Page::rowCount一致）
+    mutable QCache<int, QHash<int, QStringList>> m_residentTags; // 页号 -> 任务ID -> 标签（LRU）
+};
+
+#endif // TASKPAGER_H
@@ -0,0 +1,234 @@
+#include "taskquery.h"
+#include <QDateTime>
+#include <QStringList>
+#include <QStringView>
+
+namespace {
+typedef QList<uint> CodePoints;
+
+// 折叠大小写后按码点拆出连续的字母数字片段（代理对按一个字符处理）
+QList<CodePoints> searchRuns(const QString& text)
+{
+    QList<CodePoints> runs;
+    CodePoints run;
+    for (uint codePoint : text.toCaseFolded().toUcs4()) {
+        if (QChar::isLetterOrNumber(codePoint)) {
+            run.append(codePoint);
+        } else if (!run.isEmpty()) {
+            runs.append(run);
+            run.clear();
+        }
+    }
+    if (!run.isEmpty()) runs.append(run);
+    return runs;
+}
+
+QString fromCodePoints(const CodePoints& run, int from, int count)
+{
+    return QString::fromUcs4(reinterpret_cast<const char32_t*>(run.constData() + from), count);
+}
+}
+
+TaskQuery& TaskQuery::archived(bool archived)
+{
+    m_archived = archived;
+    return *this;
+}
+
+TaskQuery& TaskQuery::category(TaskCategory category)
+{
+    m_category = category;
+    return *this;
+}
+
+TaskQuery& TaskQuery::priority(TaskPriority priority)
+{
+    m_priority = priority;
+    return *this;
+}
+
+TaskQuery& TaskQuery::status(StatusFilter status)
+{
+    m_status = status;
+    return *this;
+}
+
+TaskQuery& TaskQuery::tag(const QString& tagName)
+{
+    m_tag = tagName.trimmed();
+    return *this;
+}
+
+TaskQuery& TaskQuery::keyword(const QString& keyword)
+{
+    m_keyword = keyword.trimmed();
+    return *this;
+}
+
+TaskQuery& TaskQuery::limit(int count)
+{
+    m_limit = count;
+    return *this;
+}
+
+TaskQuery& TaskQuery::idRange(int minId, int beforeId)
+{
+    m_minId = minId;
+    m_beforeId = beforeId;
+    return *this;
+}
+
+QString TaskQuery::toSql(const QString& columns, QVariantMap* bindings, bool fullText) const
+{
+    // 条件顺序与(is_archived, status, due_time)索引列顺序一致，状态与超期条件可直接走索引范围扫描
+    QStringList conditions;
+    conditions << "t.is_archived = :archived";
+    bindings->insert(":archived", m_archived ? 1 : 0);
+
+    switch (m_status) {
+    case Uncompleted:
+        conditions << "t.status = 0" << "t.due_time >= :now_ms";
+        bindings->insert(":now_ms", QDateTime::currentMSecsSinceEpoch());
+        break;
+    case Completed:
+        conditions << "t.status = 1";
+        break;
+    case Overdue:
+        conditions << "t.status = 0" << "t.due_time < :now_ms";
+        bindings->insert(":now_ms", QDateTime::currentMSecsSinceEpoch());
+        break;
+    case AnyStatus:
+        break;
+    }
+
+    if (m_category >= 0) {
+        conditions << "t.category = :category";
+        bindings->insert(":category", taskCategoryName(static_cast<TaskCategory>(m_category)));
+    }
+    if (m_priority >= 0) {
+        conditions << "t.priority = :priority";
+        bindings->insert(":priority", taskPriorityName(static_cast<TaskPriority>(m_priority)));
+    }
+    if (!m_tag.isEmpty()) {
+        // 标签字典很小，先定位标签再按task_tag主键(task_id, tag_id)逐行探测
+        conditions << "EXISTS (SELECT 1 FROM task_tag tt JOIN tag g ON g.id = tt.tag_id "
+                      "WHERE tt.task_id = t.id AND g.name = :tag_name)";
+        bindings->insert(":tag_name", m_tag);
+    }
+    // 关键词中没有字母或数字时不构成条件
+    const QString match = ftsMatchExpression(m_keyword);
+    if (!match.isEmpty() && fullText) {
+        conditions << "t.id IN (SELECT rowid FROM task_search WHERE task_search MATCH :fts_match)";
+        bindings->insert(":fts_match", match);
+    } else if (!match.isEmpty()) {
+        conditions << likeCondition(m_keyword, bindings);
+    }
+
+    // ID区间走主键范围扫描，翻页代价与页码无关
+    if (m_minId > 0) {
+        conditions << "t.id >= :min_id";
+        bindings->insert(":min_id", m_minId);
+    }
+    if (m_beforeId > 0) {
+        conditions << "t.id < :before_id";
+        bindings->insert(":before_id", m_beforeId);
+    }
+
+    QString sql = QString("SELECT %1 FROM tasks t WHERE %2 ORDER BY t.id DESC")
+                      .arg(columns, conditions.join(" AND "));
+    if (m_limit > 0) {
+        sql += " LIMIT :limit";
+        bindings->insert(":limit", m_limit);
+    }
+    return sql;
+}
+
+QStringList TaskQuery::searchTerms(const QString& text)
+{
+    QStringList terms;
+    for (const CodePoints& run : searchRuns(text)) {
+        terms.append(fromCodePoints(run, 0, run.count()));
+    }
+    return terms;
+}
+
+QString TaskQuery::ftsDocument(const QString& text)
+{
+    QStringList tokens;
+    for (const CodePoints& run : searchRuns(text)) {
+        for (int i = 0; i + 1 < run.count(); ++i) {
+            tokens.append(fromCodePoints(run, i, 2));
+        }
+        tokens.append(fromCodePoints(run, run.count() - 1, 1));
+    }
+    return tokens.join(' ');
+}
+
+QString TaskQuery::ftsMatchExpression(const QString& text)
+{
+    // 词只含字母和数字，放进双引号无需转义
+    QStringList phrases;
+    for (const CodePoints& run : searchRuns(text)) {
+        if (run.count() == 1) {
+            phrases.append(QString("\"%1\"*").arg(fromCodePoints(run, 0, 1)));
+            continue;
+        }
+        QStringList bigrams;
+        for (int i = 0; i + 1 < run.count(); ++i) {
+            bigrams.append(fromCodePoints(run, i, 2));
+        }
+        phrases.append(QString("\"%1\"").arg(bigrams.join(' ')));
+    }
+    return phrases.join(" AND ");
+}
+
+QString TaskQuery::likeCondition(const QString& text, QVariantMap* bindings)
+{
+    // 词中不含%、_等通配符，无需转义
+    QStringList conditions;
+    const QStringList terms = searchTerms(text);
+    for (int i = 0; i < terms.count(); ++i) {
+        QString name = QString(":like_term_%1").arg(i);
+        conditions << QString("(t.title LIKE %1 OR t.description LIKE %1 "
+                              "OR EXISTS (SELECT 1 FROM task_tag tt JOIN tag g ON g.id = tt.tag_id "
+                              "WHERE tt.task_id = t.id AND g.name LIKE %1))").arg(name);
+        bindings->insert(name, "%" + terms.at(i) + "%");
+    }
+    return conditions.join(" AND ");
+}
+
+QString TaskQuery::searchSnippet(const QString& text, const QStringList& terms, int radius)
+{
+    // 按折叠后的位置截取原文，要求折叠前后长度一致
+    const QString folded = text.toCaseFolded();
+    if (folded.length() != text.length()) return QString();
+
+    int first = -1;
+    for (const QString& term : terms) {
+        int pos = folded.indexOf(term);
+        if (pos >= 0 && (first < 0 || pos < first)) first = pos;
+    }
+    if (first < 0) return QString();
+
+    const int start = qMax(0, first - radius);
+    const int end = qMin(text.length(), first + 2 * radius);
+    QString snippet = (start > 0) ? QString("…") : QString();
+    for (int i = start; i < end;) {
+        // 同一位置有多个词命中时标出最长的
+        int matched = 0;
+        for (const QString& term : terms) {
+            if (term.length() > matched && QStringView(folded).mid(i).startsWith(term)) {
+                matched = term.length();
+            }
+        }
+        if (matched > 0) {
+            snippet += "【" + text.mid(i, matched) + "】";
+            i += matched;
+        } else {
+            snippet += text.at(i);
+            ++i;
+        }
+    }
+    if (end < text.length()) snippet += "…";
+    return snippet;
+}
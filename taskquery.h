@@ -0,0 +1,66 @@
+#ifndef TASKQUERY_H
+#define TASKQUERY_H
+
+#include <QString>
+#include <QVariantMap>
+#include <QStringList>
+#include "task.h"
+
+// 任务查询条件构造器：把筛选条件组合成一条参数化SQL，由数据库完成筛选
+// 用法：TaskQuery().category(CategoryWork).status(TaskQuery::Overdue).tag("周报")
+class TaskQuery
+{
+public:
+    // 状态筛选（与界面状态下拉框一致，超期按当前时间判断）
+    enum StatusFilter {
+        AnyStatus,   // 全部状态
+        Uncompleted, // 未完成且未超期
+        Completed,   // 已完成
+        Overdue      // 未完成且已超期
+    };
+
+    TaskQuery() = default;
+
+    TaskQuery& archived(bool archived); // 默认只查未归档任务
+    TaskQuery& category(TaskCategory category);
+    TaskQuery& priority(TaskPriority priority);
+    TaskQuery& status(StatusFilter status);
+    TaskQuery& tag(const QString& tagName); // 标签名精确匹配（区分大小写，与tag表的UNIQUE约束一致）
+    TaskQuery& keyword(const QString& keyword); // 标题、备注或标签包含关键词（语义见searchTerms()，走全文索引）
+    TaskQuery& limit(int count); // 最多返回的行数（<=0为不限制）
+    // 任务ID区间[minId, beforeId)（<=0为不限制该端），用于按ID倒序的键集分页
+    TaskQuery& idRange(int minId, int beforeId);
+
+    // 生成SQL：columns为带别名t的查询列，占位符对应的值写入bindings
+    // 结果按ID倒序；SQL形状只取决于启用了哪些条件，便于按语句缓存预编译结果
+    // fullText为false（SQLite不支持FTS5）时关键词条件改用likeCondition()
+    QString toSql(const QString& columns, QVariantMap* bindings, bool fullText = true) const;
+
+    // 关键词检索语义（全文索引、LIKE回退与实时搜索一致）：关键词折叠大小写后按字母、数字以外的字符拆成若干词，
+    // 每个词都须作为子串出现在标题、备注或某一个标签中（同样折叠大小写）
+    static QStringList searchTerms(const QString& text);
+    // task_search的索引文本（应用侧分词，按unicode61以空格切分）：每个连续的字母数字片段依次写出相邻两字的二元组，
+    // 片段末字再单独成词。n字的词对应n-1个位置相邻的二元组（短语查询），单字对应以它开头的词（前缀查询），
+    // 中文一两个字的词同样走索引
+    static QString ftsDocument(const QString& text);
+    static QString ftsMatchExpression(const QString& text); // 各词的MATCH表达式（AND连接；没有词时为空）
+    // 不支持FTS5时的回退条件：各词在标题、备注、标签上做LIKE（全表扫描，且LIKE只对ASCII不区分大小写）
+    static QString likeCondition(const QString& text, QVariantMap* bindings);
+    // 命中片段：text中第一处命中前后各约radius个字符，命中的词用【】标出（没有命中时为空）
+    static QString searchSnippet(const QString& text, const QStringList& terms, int radius);
+
+private:
+    friend class TaskBitmapIndex; // 位图索引直接读取筛选条件
+
+    bool m_archived = false;
+    int m_category = -1; // -1为不限
+    int m_priority = -1;
+    StatusFilter m_status = AnyStatus;
+    QString m_tag;
+    QString m_keyword;
+    int m_limit = 0;
+    int m_minId = 0;
+    int m_beforeId = 0;
+};
+
+#endif // TASKQUERY_H
@@ -0,0 +1,159 @@
+#include "tasksearchindex.h"
+#include "taskquery.h"
+#include <algorithm>
+#include <functional>
+
+quint64 TaskSearchIndex::gramKey(const QChar* chars, int length)
+{
+    // 每个字符占16位，最高位区分长度，单字键与二字组键不会冲突
+    quint64 key = quint64(length) << 48;
+    for (int i = 0; i < length; ++i) {
+        key |= quint64(chars[i].unicode()) << (16 * i);
+    }
+    return key;
+}
+
+QSet<quint64> TaskSearchIndex::gramKeys(const QStringList& fields)
+{
+    // 各字段分别取字，二字组不跨字段
+    QSet<quint64> keys;
+    for (const QString& field : fields) {
+        const QChar* chars = field.constData();
+        for (int i = 0; i < field.length(); ++i) {
+            keys.insert(gramKey(chars + i, 1));
+            if (i + 2 <= field.length()) keys.insert(gramKey(chars + i, 2));
+        }
+    }
+    return keys;
+}
+
+QStringList TaskSearchIndex::searchFields(const Task& task, const QStringList& tags)
+{
+    QStringList fields;
+    fields << task.title.toCaseFolded() << task.description.toCaseFolded();
+    for (const QString& tag : tags) {
+        fields << tag.toCaseFolded();
+    }
+    return fields;
+}
+
+void TaskSearchIndex::build(const QList<Task>& activeTasks, const QHash<int, QStringList>& tags)
+{
+    m_taskKeys.clear();
+    m_postings.clear();
+    m_tags = tags;
+    for (const Task& task : activeTasks) {
+        addTask(task);
+    }
+    m_built = true;
+}
+
+bool TaskSearchIndex::isBuilt() const
+{
+    return m_built;
+}
+
+void TaskSearchIndex::addTask(const Task& task)
+{
+    if (task.is_archived || task.id <= 0) return;
+
+    const QSet<quint64> keys = gramKeys(searchFields(task, m_tags.value(task.id)));
+    QVector<quint64>& taskKeys = m_taskKeys[task.id];
+    taskKeys.reserve(keys.count());
+    for (quint64 key : keys) {
+        m_postings[key].insert(task.id);
+        taskKeys.append(key);
+    }
+}
+
+void TaskSearchIndex::removeTask(int taskId)
+{
+    QHash<int, QVector<quint64>>::iterator taskKeys = m_taskKeys.find(taskId);
+    if (taskKeys == m_taskKeys.end()) return;
+
+    for (quint64 key : taskKeys.value()) {
+        QHash<quint64, QSet<int>>::iterator posting = m_postings.find(key);
+        if (posting == m_postings.end()) continue;
+        posting.value().remove(taskId);
+        if (posting.value().isEmpty()) m_postings.erase(posting);
+    }
+    m_taskKeys.erase(taskKeys);
+}
+
+void TaskSearchIndex::applyChanges(const QList<TaskChange>& changes)
+{
+    if (!m_built) return;
+
+    for (const TaskChange& change : changes) {
+        switch (change.type) {
+        case TaskChange::Deleted:
+            removeTask(change.taskId);
+            m_tags.remove(change.taskId);
+            break;
+        case TaskChange::TagsChanged:
+            // 变更应用到内存仓库后已补上任务内容
+            m_tags.insert(change.taskId, change.tags);
+            if (m_taskKeys.contains(change.taskId)) {
+                removeTask(change.taskId);
+                if (change.task.isValid()) addTask(change.task);
+            }
+            break;
+        case TaskChange::Inserted:
+        case TaskChange::Updated:
+        case TaskChange::Archived:
+        case TaskChange::Restored:
+            // 归档的任务只移除，不再加入
+            removeTask(change.taskId);
+            if (change.task.isValid()) addTask(change.task);
+            break;
+        }
+    }
+}
+
+bool TaskSearchIndex::forEachMatch(const QString& text, const TaskSnapshot& snapshot,
+                                   const std::function<bool(const Task&)>& visitor) const
+{
+    const QStringList terms = TaskQuery::searchTerms(text);
+    if (terms.isEmpty()) return true;
+
+    // 取最短的倒排表作为候选：单字的词用单字键，否则用二字组；任一键不存在即无结果
+    const QSet<int>* candidates = nullptr;
+    for (const QString& term : terms) {
+        const int gramLength = qMin(term.length(), 2);
+        const QChar* chars = term.constData();
+        for (int i = 0; i + gramLength <= term.length(); ++i) {
+            QHash<quint64, QSet<int>>::const_iterator it = m_postings.constFind(gramKey(chars + i, gramLength));
+            if (it == m_postings.constEnd()) return true;
+            if (!candidates || it.value().count() < candidates->count()) {
+                candidates = &it.value();
+            }
+        }
+    }
+
+    QVector<int> candidateIds(candidates->cbegin(), candidates->cend());
+    std::sort(candidateIds.begin(), candidateIds.end(), std::greater<int>());
+
+    // 快照中的未归档任务按ID倒序：候选也按ID倒序，一次向前推进的二分查找即可取到任务内容
+    // 候选只保证包含某个字/二字组，需再确认每个词都是某个字段的子串
+    const QList<Task>& tasks = snapshot.activeTasks;
+    QList<Task>::const_iterator from = tasks.cbegin();
+    for (int taskId : candidateIds) {
+        from = std::lower_bound(from, tasks.cend(), taskId, [](const Task& task, int id) { return task.id > id; });
+        if (from == tasks.cend()) break;
+        if (from->id != taskId) continue; // 索引尚未收到的删除或归档
+
+        const QStringList fields = searchFields(*from, m_tags.value(taskId));
+        bool matched = true;
+        for (int i = 0; matched && i < terms.count(); ++i) {
+            matched = false;
+            for (const QString& field : fields) {
+                if (field.contains(terms.at(i))) {
+                    matched = true;
+                    break;
+                }
+            }
+        }
+        if (matched && !visitor(*from)) return false;
+    }
+    return true;
+}
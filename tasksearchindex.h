@@ -0,0 +1,47 @@
+#ifndef TASKSEARCHINDEX_H
+#define TASKSEARCHINDEX_H
+
+#include <QHash>
+#include <QSet>
+#include <QVector>
+#include <QString>
+#include <QStringList>
+#include <functional>
+#include "task.h"
+#include "taskchangenotifier.h"
+#include "taskstore.h" // TaskSnapshot
+
+// 未归档任务的内存检索索引：标题、备注、各标签（大小写折叠）的单字与二字组倒排表
+// 匹配语义与全文检索一致（见TaskQuery::searchTerms()）；由变更通知逐个任务更新，不随数据版本整体重建
+// 只保存任务ID与倒排表，任务内容检索时从内存仓库的快照读取
+class TaskSearchIndex
+{
+public:
+    TaskSearchIndex() = default;
+
+    // 全量构建：activeTasks为未归档任务，tags为全部任务（含已归档）的标签
+    void build(const QList<Task>& activeTasks, const QHash<int, QStringList>& tags);
+    bool isBuilt() const;
+    void applyChanges(const QList<TaskChange>& changes);
+
+    // 依次回调匹配text的未归档任务（ID倒序），任务内容取自snapshot（不在快照中的任务跳过）；
+    // visitor返回false时停止，返回值为是否完整遍历
+    bool forEachMatch(const QString& text, const TaskSnapshot& snapshot,
+                      const std::function<bool(const Task&)>& visitor) const;
+
+private:
+    // 1~2个UTF-16字符打包为一个键
+    static quint64 gramKey(const QChar* chars, int length);
+    static QSet<quint64> gramKeys(const QStringList& fields);
+    // 折叠后的标题、备注和各标签
+    static QStringList searchFields(const Task& task, const QStringList& tags);
+    void addTask(const Task& task);
+    void removeTask(int taskId);
+
+    bool m_built = false;
+    QHash<int, QVector<quint64>> m_taskKeys; // 任务ID -> 该任务的键（移除时只清理这些倒排表）
+    QHash<int, QStringList> m_tags; // 全部任务的标签（内存仓库不含标签；含已归档，任务恢复时使用）
+    QHash<quint64, QSet<int>> m_postings; // 单字/二字组 -> 含有它的任务ID
+};
+
+#endif // TASKSEARCHINDEX_H
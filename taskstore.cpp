@@ -0,0 +1,107 @@
+#include "taskstore.h"
+
+void TaskStore::load(const QList<Task>& tasks)
+{
+    QWriteLocker locker(&m_lock);
+    m_tasks.clear();
+    for (const Task& task : tasks) {
+        m_tasks.insert(task.id, task);
+    }
+    m_loaded = true;
+    ++m_version;
+}
+
+bool TaskStore::isLoaded() const
+{
+    QReadLocker locker(&m_lock);
+    return m_loaded;
+}
+
+quint64 TaskStore::version() const
+{
+    QReadLocker locker(&m_lock);
+    return m_version;
+}
+
+void TaskStore::apply(QList<TaskChange>& changes)
+{
+    if (changes.isEmpty()) return;
+    QWriteLocker locker(&m_lock);
+    for (TaskChange& change : changes) {
+        switch (change.type) {
+        case TaskChange::Inserted:
+            if (change.task.id > 0) {
+                m_tasks.insert(change.task.id, change.task);
+            }
+            break;
+        case TaskChange::Updated: {
+            // 只更新仍在仓库中的任务，已删除的任务不会被写回
+            QMap<int, Task>::iterator it = m_tasks.find(change.taskId);
+            if (it != m_tasks.end()) {
+                it.value() = change.task;
+            }
+            break;
+        }
+        case TaskChange::Deleted:
+            m_tasks.remove(change.taskId);
+            break;
+        case TaskChange::Archived:
+        case TaskChange::Restored: {
+            QMap<int, Task>::iterator it = m_tasks.find(change.taskId);
+            if (it != m_tasks.end()) {
+                it.value().is_archived = (change.type == TaskChange::Archived) ? 1 : 0;
+                change.task = it.value();
+            }
+            break;
+        }
+        case TaskChange::TagsChanged:
+            change.task = m_tasks.value(change.taskId);
+            break;
+        }
+    }
+    ++m_version;
+}
+
+Task TaskStore::task(int taskId) const
+{
+    QReadLocker locker(&m_lock);
+    return m_tasks.value(taskId);
+}
+
+TaskSnapshotPtr TaskStore::snapshot() const
+{
+    // 先锁快照再读任务表（写操作只持有m_lock，不会死锁）
+    QMutexLocker snapshotLocker(&m_snapshotMutex);
+    QReadLocker locker(&m_lock);
+    if (m_snapshot && m_snapshot->version == m_version) {
+        return m_snapshot;
+    }
+
+    QSharedPointer<TaskSnapshot> snapshot(new TaskSnapshot);
+    snapshot->version = m_version;
+    // QMap按ID升序，反向遍历得到与原SQL一致的ID倒序
+    QMap<int, Task>::const_iterator it = m_tasks.constEnd();
+    while (it != m_tasks.constBegin()) {
+        --it;
+        if (it.value().is_archived == 0) {
+            snapshot->activeTasks.append(it.value());
+        } else {
+            snapshot->archivedTasks.append(it.value());
+        }
+    }
+    m_snapshot = snapshot;
+    return m_snapshot;
+}
+
+TaskColumnsPtr TaskStore::activeColumns() const
+{
+    // 只在统计时才需要列式数据：写入频繁时不随每次写入重建，按需构建一次后复用到下一次写入
+    // 列式数据不做增量维护：任何写入之后的第一次统计都会对全部未归档任务重新排序（O(n log n)）
+    QMutexLocker columnsLocker(&m_columnsMutex);
+    TaskSnapshotPtr current = snapshot();
+    if (m_columns && m_columns->version == current->version) {
+        return m_columns;
+    }
+    m_columns = TaskColumnsPtr(new TaskColumns(TaskColumns::fromTasks(current->activeTasks, current->version)));
+    return m_columns;
+}
@@ -0,0 +1,59 @@
+#ifndef TASKSTORE_H
+#define TASKSTORE_H
+
+#include <QList>
+#include <QMap>
+#include <QMutex>
+#include <QReadWriteLock>
+#include <QSharedPointer>
+#include "task.h"
+#include "taskcolumns.h"
+#include "taskchangenotifier.h"
+
+// 任务快照：某一版本下的只读任务列表（隐式共享，可跨线程传递）
+struct TaskSnapshot {
+    quint64 version = 0;
+    QList<Task> activeTasks;   // 未归档任务，按ID倒序
+    QList<Task> archivedTasks; // 已归档任务，按ID倒序
+};
+typedef QSharedPointer<const TaskSnapshot> TaskSnapshotPtr;
+
+// 内存任务仓库（写穿透）：启动时一次性装载，之后由DatabaseManager在写入提交后按变更同步维护
+class TaskStore
+{
+public:
+    TaskStore() = default;
+
+    // 全量装载（替换当前内容）
+    void load(const QList<Task>& tasks);
+    bool isLoaded() const;
+    // 当前数据版本号（每次变更递增）
+    quint64 version() const;
+
+    // 应用一次提交的全部行级变更（仅在事务提交后调用），版本号只递增一次；
+    // 归档、恢复与标签变更只带任务ID，应用后补上变更后的任务
+    void apply(QList<TaskChange>& changes);
+
+    // 读操作
+    Task task(int taskId) const;
+    TaskSnapshotPtr snapshot() const;
+    // 未归档任务的列式数据（按截止时间升序），首次请求时由当前快照构建并按版本缓存
+    TaskColumnsPtr activeColumns() const;
+
+private:
+    TaskStore(const TaskStore&) = delete;
+    TaskStore& operator=(const TaskStore&) = delete;
+
+    mutable QReadWriteLock m_lock; // 保护任务表与版本号
+    QMap<int, Task> m_tasks; // 任务ID -> 任务（按ID升序）
+    quint64 m_version = 0;
+    bool m_loaded = false;
+
+    mutable QMutex m_snapshotMutex; // 保护快照缓存的重建
+    mutable TaskSnapshotPtr m_snapshot; // 按版本缓存的快照，版本不变时直接复用
+
+    mutable QMutex m_columnsMutex; // 保护列式数据缓存的重建
+    mutable TaskColumnsPtr m_columns; // 按版本缓存的列式数据
+};
+
+#endif // TASKSTORE_H
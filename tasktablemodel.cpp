@@ -3,21 +3,39 @@
 #include <QDateTime>
 #include <QBrush>
 #include <QColor>
+#include <algorithm>
+#include <functional>
+
+namespace {
+const int kPageSize = 256; // 视图每次滚动到末尾时追加的行数
+const int kWindowRows = 1024; // 常驻ID的行数（可见行数的若干倍，滚动时很少重新换算）
+}
 
 // 构造函数实现
 TaskTableModel::TaskTableModel(QObject *parent)
     : QAbstractTableModel(parent)
+    , m_loadedRows(0)
+    , m_windowFirst(0)
+    , m_taskCache(4096)
+    , m_deadlineTimer(DeadlineQueue::createTimer(this))
+    , m_showingQuery(true)
+    , m_displayCache(4096)
     , m_filterCategory("全部分类")
     , m_filterPriority("全部优先级")
     , m_filterStatus("全部状态")
     , m_filterTag("全部标签")
 {
+    connect(DatabaseManager::instance().changeNotifier(), &TaskChangeNotifier::tasksChanged,
+            this, &TaskTableModel::applyTaskChanges);
+
+    // 超期标识按截止时间精确翻转，不依赖周期刷新
+    connect(m_deadlineTimer, &QTimer::timeout, this, &TaskTableModel::onDeadlineReached);
 }
 
 int TaskTableModel::rowCount(const QModelIndex &parent) const
 {
     Q_UNUSED(parent);
-    return m_filteredTaskList.count();
+    return m_showingQuery ? m_loadedRows : m_filteredTaskList.count();
 }
 
 int TaskTableModel::columnCount(const QModelIndex &parent) const
@@ -28,54 +46,45 @@ int TaskTableModel::columnCount(const QModelIndex &parent) const
 
 QVariant TaskTableModel::data(const QModelIndex &index, int role) const
 {
-    if (!index.isValid() || index.row() >= m_filteredTaskList.count()) {
+    const Task* row = index.isValid() ? taskAtRow(index.row()) : nullptr;
+    if (!row) {
         return QVariant();
     }
 
-    const Task& task = m_filteredTaskList.at(index.row());
-    QDateTime currentTime = QDateTime::currentDateTime();
-    // 超期判断（兼容原有统计逻辑）
-    bool isOverdue = (task.status == 0 && task.dueTime < currentTime);
+    const Task& task = *row;
 
-    // 1. 原有显示逻辑
+    // 1. 原有显示逻辑（标题与枚举名称本身即为共享字符串，其余列取自行缓存）
     if (role == Qt::DisplayRole) {
         switch (index.column()) {
         case 0: return task.title;
-        case 1: return task.category;
-        case 2: return task.priority;
-        case 3:
-            // 超期任务追加标识
-            if (isOverdue) {
-                return QString("%1 （已超期）").arg(task.dueTime.toString("yyyy-MM-dd HH:mm:ss"));
-            }
-            return task.dueTime.toString("yyyy-MM-dd HH:mm:ss");
-        case 4:
-            if (isOverdue) {
-                return "未完成（已超期）";
-            }
-            return task.status == 0 ? "未完成" : "已完成";
-        case 5: return QString("%1%").arg(task.progress);
-        case 6: return DatabaseManager::instance().getTagsForTask(task.id).join(", ");
+        case 1: return taskCategoryName(task.category);
+        case 2: return taskPriorityName(task.priority);
+        case 3: return displayOf(task)->dueTime; // 超期任务追加标识
+        case 4: return displayOf(task)->status;
+        case 5: return displayOf(task)->progress;
+        case 6: return displayOf(task)->tags;
         default: return QVariant();
         }
     }
 
-    // 2. 优先级颜色标识（仅优先级列：索引2）
+    // 2. 优先级颜色标识（仅优先级列：索引2）；画刷只构造一次
     if (role == Qt::ForegroundRole && index.column() == 2) {
-        QString priority = task.priority.trimmed().toUpper();
-        if (priority == "高" || priority == "HIGH") {
-            return QBrush(Qt::red); // 高优先级：红色文字
-        } else if (priority == "中" || priority == "MIDDLE" || priority == "MEDIUM") {
-            return QBrush(QColor(255, 140, 0)); // 中优先级：自定义深橙色
-        } else if (priority == "低" || priority == "LOW") {
-            return QBrush(Qt::darkGreen); // 低优先级：深绿色文字
+        static const QBrush highBrush(Qt::red); // 高优先级：红色文字
+        static const QBrush mediumBrush(QColor(255, 140, 0)); // 中优先级：自定义深橙色
+        static const QBrush lowBrush(Qt::darkGreen); // 低优先级：深绿色文字
+        static const QBrush defaultBrush(Qt::black); // 默认：黑色文字
+        switch (task.priority) {
+        case PriorityHigh: return highBrush;
+        case PriorityMedium: return mediumBrush;
+        case PriorityLow: return lowBrush;
+        default: return defaultBrush;
         }
-        return QBrush(Qt::black); // 默认：黑色文字
     }
 
     // 3. 超期任务整行背景色标识（不影响优先级颜色）
-    if (isOverdue && role == Qt::BackgroundRole) {
-        return QBrush(QColor(255, 220, 220)); // 浅红背景，醒目不刺眼
+    if (role == Qt::BackgroundRole && displayOf(task)->overdue) {
+        static const QBrush overdueBrush(QColor(255, 220, 220)); // 浅红背景，醒目不刺眼
+        return overdueBrush;
     }
 
     return QVariant();
@@ -103,23 +112,334 @@ void TaskTableModel::setTaskList(const QList<Task> &taskList)
 {
     beginResetModel();
     m_filteredTaskList = taskList;
+    m_showingQuery = false;
+    // 释放筛选结果（筛选条件保留，供之后刷新使用）
+    m_result.clear();
+    m_loadedRows = 0;
+    m_windowIds.clear();
+    m_taskCache.clear();
+    m_rowTags.clear();
+    m_pendingTagRows.clear();
+    QVector<int> taskIds;
+    taskIds.reserve(taskList.count());
+    for (const Task& task : taskList) {
+        taskIds.append(task.id);
+    }
+    loadRowTags(taskIds);
     endResetModel();
 }
 
+void TaskTableModel::appendTasks(const QList<Task> &tasks)
+{
+    if (tasks.isEmpty()) return;
+    QVector<int> taskIds;
+    taskIds.reserve(tasks.count());
+    for (const Task& task : tasks) {
+        taskIds.append(task.id);
+    }
+    loadRowTags(taskIds);
+    const int first = m_filteredTaskList.count();
+    beginInsertRows(QModelIndex(), first, first + tasks.count() - 1);
+    m_filteredTaskList.append(tasks);
+    endInsertRows();
+}
+
 void TaskTableModel::refreshTasks()
 {
-    beginResetModel();
-    m_taskList = DatabaseManager::instance().getAllTasks();
+    // 位图索引由变更通知维护，无需重建；只丢弃显示用的缓存
+    m_displayCache.clear();
+    m_taskCache.clear();
+    // 按当前筛选条件重新查询（内部重置模型）
     setFilterConditions(m_filterCategory, m_filterPriority, m_filterStatus, m_filterTag);
-    endResetModel();
+}
+
+bool TaskTableModel::canFetchMore(const QModelIndex &parent) const
+{
+    return !parent.isValid() && m_showingQuery && m_loadedRows < m_result.count();
+}
+
+void TaskTableModel::fetchMore(const QModelIndex &parent)
+{
+    if (!canFetchMore(parent)) return;
+
+    // 已加载的行即结果中ID最大的若干个，追加一页只增加行数；各行的ID与标签在进入窗口时换算与装入
+    const int first = m_loadedRows;
+    const int count = qMin(kPageSize, m_result.count() - m_loadedRows);
+    beginInsertRows(QModelIndex(), first, first + count - 1);
+    m_loadedRows += count;
+    endInsertRows();
+}
+
+int TaskTableModel::rowTaskId(int row) const
+{
+    if (row >= m_windowFirst && row < m_windowFirst + m_windowIds.count()) {
+        return m_windowIds.at(row - m_windowFirst);
+    }
+
+    // 以该行为中心重新换算一段：由行号求出首行ID，再从它起倒序取出其余各行
+    m_windowFirst = qMax(0, row - kWindowRows / 2);
+    const int last = qMin(m_loadedRows, m_windowFirst + kWindowRows);
+    m_windowIds.clear();
+    m_windowIds.reserve(last - m_windowFirst);
+    m_result.forEachDescending([&](int taskId) -> bool {
+        m_windowIds.append(taskId);
+        return m_windowFirst + m_windowIds.count() < last;
+    }, m_result.valueAtDescending(m_windowFirst) + 1);
+    // 标签只保留窗口内的行：窗口外的行已生成的显示文字仍在缓存中，再次进入窗口时重新装入
+    m_rowTags.clear();
+    loadRowTags(m_windowIds);
+    return m_windowIds.at(row - m_windowFirst);
+}
+
+void TaskTableModel::ensureIndex()
+{
+    if (m_index.isBuilt()) return;
+    DatabaseManager& db = DatabaseManager::instance();
+    m_index.build(db.taskSnapshot()->activeTasks, db.getTagsForAllTasks(), QDateTime::currentMSecsSinceEpoch());
+}
+
+const Task* TaskTableModel::taskAtRow(int row) const
+{
+    if (m_showingQuery) {
+        if (row < 0 || row >= m_loadedRows) return nullptr;
+        // 表中只保存ID，任务内容按需从内存仓库读取并缓存（返回的指针在下一次读取其他任务前有效）
+        const int taskId = rowTaskId(row);
+        if (Task* task = m_taskCache.object(taskId)) return task;
+        Task* task = new Task(DatabaseManager::instance().getTaskById(taskId));
+        m_taskCache.insert(taskId, task);
+        return task;
+    }
+    return (row >= 0 && row < m_filteredTaskList.count()) ? &m_filteredTaskList.at(row) : nullptr;
 }
 
 Task TaskTableModel::getTaskAt(int row) const
 {
-    if (row >= 0 && row < m_filteredTaskList.count()) {
-        return m_filteredTaskList.at(row);
+    const Task* task = taskAtRow(row);
+    return task ? *task : Task();
+}
+
+DatabaseManager::TaskSource TaskTableModel::taskSource() const
+{
+    if (m_showingQuery) {
+        // 位图隐式共享，复制即固定当前结果
+        const TaskBitmap result = m_result;
+        return [result](const DatabaseManager::TaskVisitor& visitor) -> bool {
+            DatabaseManager& db = DatabaseManager::instance();
+            result.forEachDescending([&](int taskId) -> bool {
+                return visitor(db.getTaskById(taskId));
+            });
+            return true;
+        };
+    }
+    const QList<Task> tasks = m_filteredTaskList;
+    return [tasks](const DatabaseManager::TaskVisitor& visitor) -> bool {
+        for (const Task& task : tasks) {
+            if (!visitor(task)) break;
+        }
+        return true;
+    };
+}
+
+const TaskTableModel::RowDisplay* TaskTableModel::displayOf(const Task &task) const
+{
+    if (RowDisplay* display = m_displayCache.object(task.id)) {
+        return display;
+    }
+
+    // 超期标识由索引维护（截止时间到达时由定时器翻转并作废本缓存），生成时也不读取时钟
+    RowDisplay* display = new RowDisplay;
+    display->overdue = m_index.isOverdue(task.id);
+    const QString dueTime = task.dueTime.toString("yyyy-MM-dd HH:mm:ss");
+    display->dueTime = display->overdue ? QString("%1 （已超期）").arg(dueTime) : dueTime;
+    display->status = display->overdue ? QString("未完成（已超期）") : taskStatusName(task.status);
+    display->progress = QString("%1%").arg(int(task.progress));
+    display->tags = m_rowTags.value(task.id);
+    m_displayCache.insert(task.id, display);
+    return display;
+}
+
+void TaskTableModel::updateTaskTags(int taskId, const QStringList &tags)
+{
+    // 仅刷新该任务所在行的标签列
+    int row = rowOfTask(taskId);
+    if (row >= 0) {
+        m_rowTags.insert(taskId, tags.join(", "));
+        if (RowDisplay* display = m_displayCache.object(taskId)) {
+            display->tags = m_rowTags.value(taskId);
+        }
+        QModelIndex tagIndex = index(row, 6);
+        emit dataChanged(tagIndex, tagIndex, {Qt::DisplayRole});
+    }
+}
+
+void TaskTableModel::loadRowTags(const QVector<int> &taskIds) const
+{
+    if (taskIds.isEmpty()) return;
+    const QHash<int, QStringList> tags = DatabaseManager::instance().getTagsForTasks(taskIds);
+    for (int taskId : taskIds) {
+        m_rowTags.insert(taskId, tags.value(taskId).join(", "));
+        m_displayCache.remove(taskId);
     }
-    return Task();
+}
+
+void TaskTableModel::loadPendingRowTags()
+{
+    QVector<int> taskIds;
+    for (int taskId : m_pendingTagRows) {
+        // 已移出表格或标签已由变更通知带来的行不再查询
+        if (!m_rowTags.contains(taskId) && rowOfTask(taskId) >= 0) taskIds.append(taskId);
+    }
+    m_pendingTagRows.clear();
+    loadRowTags(taskIds);
+    for (int taskId : taskIds) {
+        QModelIndex tagIndex = index(rowOfTask(taskId), 6);
+        emit dataChanged(tagIndex, tagIndex, {Qt::DisplayRole});
+    }
+}
+
+void TaskTableModel::onDeadlineReached()
+{
+    const QVector<int> crossed = m_index.advanceClock(QDateTime::currentMSecsSinceEpoch());
+    DatabaseManager& db = DatabaseManager::instance();
+    for (int taskId : crossed) {
+        placeTask(db.getTaskById(taskId));
+    }
+    loadPendingRowTags();
+    if (!crossed.isEmpty()) emit facetCountsChanged();
+    scheduleDeadlineTimer();
+}
+
+void TaskTableModel::scheduleDeadlineTimer()
+{
+    // 截止时间之后1毫秒触发（超期判断为截止时间严格早于当前时间）
+    const qint64 deadline = m_index.nextDeadline();
+    DeadlineQueue::armTimer(m_deadlineTimer, deadline < 0 ? -1 : deadline + 1);
+}
+
+TaskBitmapIndex::FacetCounts TaskTableModel::facetCounts() const
+{
+    return m_index.facetCounts(m_query);
+}
+
+int TaskTableModel::rowOfTask(int taskId) const
+{
+    if (m_showingQuery) {
+        // 结果中比它大的ID个数即行号；不小于已加载行数的行尚未加载
+        if (!m_result.contains(taskId)) return -1;
+        const int row = m_result.countAbove(taskId);
+        return row < m_loadedRows ? row : -1;
+    }
+    for (int row = 0; row < m_filteredTaskList.count(); ++row) {
+        if (m_filteredTaskList.at(row).id == taskId) return row;
+    }
+    return -1;
+}
+
+void TaskTableModel::removeTaskRow(int row)
+{
+    beginRemoveRows(QModelIndex(), row, row);
+    if (m_showingQuery) {
+        const int taskId = m_result.valueAtDescending(row);
+        m_rowTags.remove(taskId);
+        m_result.remove(taskId);
+        --m_loadedRows;
+        // 窗口之前的行被移除时窗口整体上移一行
+        if (row < m_windowFirst) {
+            --m_windowFirst;
+        } else if (row < m_windowFirst + m_windowIds.count()) {
+            m_windowIds.removeAt(row - m_windowFirst);
+        }
+    } else {
+        m_rowTags.remove(m_filteredTaskList.at(row).id);
+        m_filteredTaskList.removeAt(row);
+    }
+    endRemoveRows();
+}
+
+void TaskTableModel::placeTask(const Task &task)
+{
+    m_displayCache.remove(task.id);
+    int row = rowOfTask(task.id);
+    if (!m_showingQuery) {
+        // 搜索结果不随变更增加新行，只刷新已有行
+        if (row < 0) return;
+        if (task.is_archived) {
+            removeTaskRow(row);
+        } else {
+            m_filteredTaskList[row] = task;
+            emit dataChanged(index(row, 0), index(row, columnCount() - 1));
+        }
+        return;
+    }
+
+    // 索引已应用本次变更，直接按位判断是否满足筛选条件
+    const bool wanted = m_index.matches(task.id, m_query);
+    m_taskCache.remove(task.id);
+
+    if (row >= 0 && wanted) {
+        emit dataChanged(index(row, 0), index(row, columnCount() - 1));
+    } else if (row >= 0) {
+        removeTaskRow(row); // 同时移出结果
+    } else if (!wanted) {
+        m_result.remove(task.id);
+    } else if (!m_result.contains(task.id)) {
+        // 已加载的行是结果中ID最大的部分：新ID落在其后且还有未加载的行时只加入结果，之后随分页取得
+        const int targetRow = m_result.countAbove(task.id);
+        if (targetRow == m_loadedRows && m_loadedRows < m_result.count()) {
+            m_result.add(task.id);
+            return;
+        }
+        beginInsertRows(QModelIndex(), targetRow, targetRow);
+        m_result.add(task.id);
+        ++m_loadedRows;
+        if (targetRow < m_windowFirst) {
+            ++m_windowFirst;
+        } else if (targetRow <= m_windowFirst + m_windowIds.count()) {
+            m_windowIds.insert(targetRow - m_windowFirst, task.id);
+        }
+        m_pendingTagRows.append(task.id);
+        endInsertRows();
+    }
+}
+
+void TaskTableModel::applyTaskChanges(const QList<TaskChange> &changes)
+{
+    // 先更新索引，再按索引判断各行的去留
+    m_index.applyChanges(changes, QDateTime::currentMSecsSinceEpoch());
+
+    for (const TaskChange& change : changes) {
+        switch (change.type) {
+        case TaskChange::Deleted: {
+            m_displayCache.remove(change.taskId);
+            m_taskCache.remove(change.taskId);
+            int row = rowOfTask(change.taskId);
+            if (row >= 0) {
+                removeTaskRow(row); // 同时移出结果
+            } else {
+                m_result.remove(change.taskId);
+            }
+            break;
+        }
+        case TaskChange::TagsChanged:
+            // 标签筛选可能因此改变匹配结果；placeTask()同时作废该行的显示文字
+            if (change.task.isValid()) placeTask(change.task);
+            // 通知中已带有新标签，仍在表中的行直接更新，不查询数据库
+            if (rowOfTask(change.taskId) >= 0) {
+                m_rowTags.insert(change.taskId, change.tags.join(", "));
+                m_displayCache.remove(change.taskId);
+            }
+            break;
+        case TaskChange::Inserted:
+        case TaskChange::Updated:
+        case TaskChange::Archived:
+        case TaskChange::Restored:
+            if (change.task.isValid()) placeTask(change.task);
+            break;
+        }
+    }
+    loadPendingRowTags();
+    scheduleDeadlineTimer();
+    emit facetCountsChanged();
 }
 
 void TaskTableModel::setFilterConditions(const QString &category, const QString &priority,
@@ -130,31 +450,38 @@ void TaskTableModel::setFilterConditions(const QString &category, const QString
     m_filterStatus = status;
     m_filterTag = tag;
 
-    m_filteredTaskList.clear();
-    QDateTime currentTime = QDateTime::currentDateTime();
-    for (const Task& task : m_taskList) {
-        if (category != "全部分类" && task.category != category) continue;
-        if (priority != "全部优先级" && task.priority != priority) continue;
-        QString taskStatusText = task.status == 0 ? "未完成" : "已完成";
-        // 兼容超期状态筛选
-        bool isOverdue = (task.status == 0 && task.dueTime < currentTime);
-        QString actualStatusText = isOverdue ? "未完成（已超期）" : taskStatusText;
-        if (status != "全部状态" && actualStatusText != status) continue;
-        if (tag != "全部标签") {
-            QStringList taskTags = DatabaseManager::instance().getTagsForTask(task.id);
-            if (!taskTags.contains(tag, Qt::CaseInsensitive)) continue;
-        }
-        m_filteredTaskList.append(task);
-    }
+    // 筛选文本转换为查询条件，由位图索引求出全部匹配的任务ID，模型只加载第一页
+    TaskQuery query;
+    if (category != "全部分类") query.category(taskCategoryFromName(category));
+    if (priority != "全部优先级") query.priority(taskPriorityFromName(priority));
+    // 超期按当前时间判断：未完成分为未超期与已超期两类
+    if (status == "未完成") query.status(TaskQuery::Uncompleted);
+    else if (status == "已完成") query.status(TaskQuery::Completed);
+    else if (status == "未完成（已超期）") query.status(TaskQuery::Overdue);
+    if (tag != "全部标签") query.tag(tag);
+
+    ensureIndex();
+    m_index.advanceClock(QDateTime::currentMSecsSinceEpoch());
+    scheduleDeadlineTimer();
 
+    // 只取第一页即可显示，其余在视图滚动到末尾时由fetchMore按需加载
     beginResetModel();
+    m_showingQuery = true;
+    m_filteredTaskList.clear();
+    m_query = query;
+    m_result = m_index.evaluate(query);
+    m_loadedRows = qMin(kPageSize, m_result.count());
+    m_windowIds.clear(); // 首次绘制时换算首页的ID并装入标签
+    m_rowTags.clear();
+    m_pendingTagRows.clear();
     endResetModel();
+    emit facetCountsChanged();
 }
 
 bool TaskTableModel::setData(const QModelIndex &index, const QVariant &value, int role)
 {
     Q_UNUSED(value); // 消除未使用参数警告
-    if (!index.isValid() || index.row() >= m_filteredTaskList.count() || role != Qt::EditRole) {
+    if (!index.isValid() || index.row() >= rowCount() || role != Qt::EditRole) {
         return false;
     }
     return false;
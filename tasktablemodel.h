@@ -3,7 +3,15 @@
 
 #include <QAbstractTableModel>
 #include <QList>
+#include <QHash>
+#include <QVector>
+#include <QCache>
+#include <QStringList>
+#include <QTimer>
 #include "databasemanager.h"
+#include "taskquery.h"
+#include "taskchangenotifier.h"
+#include "taskbitmapindex.h"
 
 class TaskTableModel : public QAbstractTableModel
 {
@@ -19,16 +27,80 @@ public:
     QVariant headerData(int section, Qt::Orientation orientation, int role = Qt::DisplayRole) const override;
     bool setData(const QModelIndex &index, const QVariant &value, int role = Qt::EditRole) override;
     Qt::ItemFlags flags(const QModelIndex &index) const override;
+    // 筛选结果分页加载：视图滚动到末尾时取下一页
+    bool canFetchMore(const QModelIndex &parent) const override;
+    void fetchMore(const QModelIndex &parent) override;
 
 
     void setTaskList(const QList<Task> &taskList);
+    // 在末尾追加任务（流式结果分批到达时使用，不重置模型）
+    void appendTasks(const QList<Task> &tasks);
     void refreshTasks();
     void setFilterConditions(const QString &category, const QString &priority, const QString &status, const QString &tag);
     Task getTaskAt(int row) const;
+    // 当前表格内容的逐行数据源（筛选结果从数据库流式读取全部匹配行，不限于已加载的页）
+    DatabaseManager::TaskSource taskSource() const;
+    // 任务标签变更后更新该行的标签文字（不触发SQL查询）
+    void updateTaskTags(int taskId, const QStringList &tags);
+    // 各筛选下拉选项的任务数（按位图索引计算，不查询数据库）
+    TaskBitmapIndex::FacetCounts facetCounts() const;
+
+signals:
+    // 筛选条件或任务数据变化后发出，界面据此更新下拉选项的计数
+    void facetCountsChanged();
+
+public slots:
+    // 按行应用数据库变更通知：只插入、刷新或移除受影响的行，不重置模型
+    void applyTaskChanges(const QList<TaskChange> &changes);
+
+private slots:
+    // 截止时间到达：刚超期的任务按当前状态筛选移入或移出结果，仍在表中的行重绘，其余行不受影响
+    void onDeadlineReached();
 
 private:
-    QList<Task> m_taskList;
-    QList<Task> m_filteredTaskList;
+    // 行的显示文字：首次显示时一次生成，之后绘制直接返回（隐式共享，不再分配）
+    // 任务或标签变更、超期翻转时作废
+    struct RowDisplay {
+        QString dueTime; // 超期时带标识
+        QString status;
+        QString progress;
+        QString tags;
+        bool overdue = false;
+    };
+
+    void ensureIndex();
+    // 按索引中最近的截止时间安排下一次超期检查（索引变化后调用）
+    void scheduleDeadlineTimer();
+    // 筛选结果中指定行的任务ID：不在窗口内时把窗口移到该行附近，并装入窗口内各行的标签
+    int rowTaskId(int row) const;
+    const Task* taskAtRow(int row) const;
+    // 任务所在行（未找到返回-1）：筛选结果按ID二分查找，搜索结果逐行查找
+    int rowOfTask(int taskId) const;
+    void removeTaskRow(int row);
+    // 一次查询装入一批行的标签（窗口移动与搜索结果分批到达时调用），并作废这些行的显示文字
+    void loadRowTags(const QVector<int> &taskIds) const;
+    // 装入变更通知中新进入表格、标签尚未装入的行（每批通知最多查询一次）
+    void loadPendingRowTags();
+    // 按当前筛选条件决定任务是否应在表中：插入、原地刷新或移除
+    void placeTask(const Task &task);
+    // 取行的显示文字（不在缓存中时生成；返回的指针在下一次生成其他行之前有效）
+    const RowDisplay* displayOf(const Task &task) const;
+
+    TaskBitmapIndex m_index; // 未归档任务的分面位图索引（首次筛选时构建，之后随变更通知维护）
+    TaskQuery m_query; // 当前筛选条件
+    TaskBitmap m_result; // 满足筛选条件的全部任务ID
+    int m_loadedRows; // 已加载到表中的行数：各行即m_result中ID最大的这些个（倒序），行号与ID由位图换算
+    // 可见区附近一段连续行的任务ID：只有这一段常驻，滚动到段外时重新换算，内存不随已加载的行数增长
+    mutable int m_windowFirst;
+    mutable QVector<int> m_windowIds;
+    mutable QCache<int, Task> m_taskCache; // 任务ID -> 任务内容（按需从内存仓库读取）
+    QTimer* m_deadlineTimer; // 单次定时器，在最近的截止时间到达时触发
+    QList<Task> m_filteredTaskList; // 外部设置的任务列表（搜索结果）
+    bool m_showingQuery; // true：表中为筛选结果；false：表中为外部设置的搜索结果
+    mutable QCache<int, RowDisplay> m_displayCache; // 任务ID -> 显示文字
+    // 任务ID -> 标签文字：筛选结果只保存窗口内的行（随窗口整段装入），搜索结果保存全部行；绘制时不查询数据库
+    mutable QHash<int, QString> m_rowTags;
+    QVector<int> m_pendingTagRows; // 新进入表格、待装入标签的任务ID
     QString m_filterCategory;
     QString m_filterPriority;
     QString m_filterStatus;
@@ -0,0 +1,11 @@
+# 各测试程序的公共配置：被测源文件直接从项目根目录编译进测试程序
+lessThan(QT_MAJOR_VERSION, 6): error("测试程序需要Qt 6或更高版本（当前为Qt $$QT_VERSION）")
+
+QT += testlib
+QT -= gui
+CONFIG += c++17 console testcase
+CONFIG -= app_bundle
+
+APP_DIR = $$PWD/..
+INCLUDEPATH += $$APP_DIR
+DEPENDPATH += $$APP_DIR
@@ -0,0 +1,12 @@
+TEMPLATE = subdirs
+
+SUBDIRS += \
+    tst_asyncdatabase \
+    tst_databasemanager \
+    tst_deadlinequeue \
+    tst_migration \
+    tst_reminderscheduler \
+    tst_taskbitmap \
+    tst_taskpager \
+    tst_taskquery \
+    tst_tasksearchindex
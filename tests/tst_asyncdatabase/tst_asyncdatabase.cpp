@@ -0,0 +1,112 @@
+#include <QtTest>
+#include <QSemaphore>
+#include <QTemporaryDir>
+#include "asyncdatabase.h"
+
+// 数据库线程的出队顺序：交互通道先于后台通道，交互任务不越过同一调用方先提交的冲突任务
+// 先提交一个占住数据库线程的任务，其余任务都在队列中等待，放行后按出队顺序取得序号
+class tst_AsyncDatabase : public QObject
+{
+    Q_OBJECT
+
+private slots:
+    void initTestCase();
+    void cleanupTestCase();
+    void interactiveReadOvertakesBulkJob();
+    void readWaitsForEarlierWriteFromSameCaller();
+    void readFromAnotherCallerOvertakesWrite();
+
+private:
+    // 返回执行顺序（从0开始）的任务
+    QFuture<int> submit(AsyncDatabase::Priority priority, AsyncDatabase::Access access);
+    // 占住数据库线程直到release()
+    void block();
+    void release();
+
+    QTemporaryDir m_dir;
+    QSemaphore m_gate;
+    QFuture<bool> m_blocker;
+    QAtomicInt m_order;
+};
+
+void tst_AsyncDatabase::initTestCase()
+{
+    QVERIFY(m_dir.isValid());
+    DatabaseManager::instance().setDatabasePath(m_dir.filePath("task_database.db"));
+    QVERIFY(DatabaseManager::instance().init());
+}
+
+void tst_AsyncDatabase::cleanupTestCase()
+{
+    AsyncDatabase::instance().shutdown();
+}
+
+QFuture<int> tst_AsyncDatabase::submit(AsyncDatabase::Priority priority, AsyncDatabase::Access access)
+{
+    QAtomicInt* order = &m_order;
+    return AsyncDatabase::instance().run(priority, access, [order]() { return order->fetchAndAddOrdered(1); });
+}
+
+void tst_AsyncDatabase::block()
+{
+    m_order.storeRelaxed(0);
+    QSemaphore* gate = &m_gate;
+    m_blocker = AsyncDatabase::instance().run(AsyncDatabase::Background, AsyncDatabase::Read, [gate]() {
+        gate->acquire();
+        return true;
+    });
+}
+
+void tst_AsyncDatabase::release()
+{
+    m_gate.release();
+    m_blocker.waitForFinished();
+}
+
+void tst_AsyncDatabase::interactiveReadOvertakesBulkJob()
+{
+    block();
+    QFuture<int> bulk = submit(AsyncDatabase::Background, AsyncDatabase::Read);
+    QFuture<int> read = submit(AsyncDatabase::Interactive, AsyncDatabase::Read);
+    release();
+
+    QCOMPARE(read.result(), 0);
+    QCOMPARE(bulk.result(), 1);
+}
+
+void tst_AsyncDatabase::readWaitsForEarlierWriteFromSameCaller()
+{
+    block();
+    QFuture<int> bulkRead = submit(AsyncDatabase::Background, AsyncDatabase::Read);
+    QFuture<int> bulkWrite = submit(AsyncDatabase::Background, AsyncDatabase::Write);
+    QFuture<int> read = submit(AsyncDatabase::Interactive, AsyncDatabase::Read);
+    QFuture<int> write = submit(AsyncDatabase::Interactive, AsyncDatabase::Write);
+    release();
+
+    // 读取与写入都排在同一线程先提交的批量写入之后，通道内仍先进先出
+    QCOMPARE(bulkRead.result(), 0);
+    QCOMPARE(bulkWrite.result(), 1);
+    QCOMPARE(read.result(), 2);
+    QCOMPARE(write.result(), 3);
+}
+
+void tst_AsyncDatabase::readFromAnotherCallerOvertakesWrite()
+{
+    block();
+    QFuture<int> bulkWrite = submit(AsyncDatabase::Background, AsyncDatabase::Write);
+    QFuture<int> read;
+    QThread* caller = QThread::create([this, &read]() {
+        read = submit(AsyncDatabase::Interactive, AsyncDatabase::Read);
+    });
+    caller->start();
+    caller->wait();
+    delete caller;
+    release();
+
+    QCOMPARE(read.result(), 0);
+    QCOMPARE(bulkWrite.result(), 1);
+}
+
+QTEST_GUILESS_MAIN(tst_AsyncDatabase)
+
+#include "tst_asyncdatabase.moc"
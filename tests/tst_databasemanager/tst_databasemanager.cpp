@@ -0,0 +1,260 @@
+#include <QtTest>
+#include <QTemporaryDir>
+#include "databasemanager.h"
+
+// DatabaseManager的事务、内存仓库同步与批量写入（使用临时目录中的数据库文件）
+class tst_DatabaseManager : public QObject
+{
+    Q_OBJECT
+
+private slots:
+    void initTestCase();
+    void initTwiceKeepsStore();
+    void writeUpdatesStoreAfterCommit();
+    void updateOfDeletedTaskFails();
+    void transactionDefersStoreUntilCommit();
+    void rollbackDiscardsPendingChanges();
+    void savepointRollbackKeepsOuterChanges();
+    void archiveReportsArchivedTasks();
+    void emptyTagListClearsTags();
+    void tagsForTasksInOneQuery();
+    void bulkInsert_data();
+    void bulkInsert();
+
+private:
+    static Task makeTask(const QString& title, TaskStatus status = StatusUncompleted);
+    static bool storeContains(int taskId);
+
+    QTemporaryDir m_dir;
+};
+
+Task tst_DatabaseManager::makeTask(const QString& title, TaskStatus status)
+{
+    Task task;
+    task.title = title;
+    task.category = CategoryStudy;
+    task.priority = PriorityMedium;
+    task.status = status;
+    task.dueTime = QDateTime::currentDateTime().addDays(1);
+    return task;
+}
+
+bool tst_DatabaseManager::storeContains(int taskId)
+{
+    return DatabaseManager::instance().getTaskById(taskId).isValid();
+}
+
+void tst_DatabaseManager::initTestCase()
+{
+    QVERIFY(m_dir.isValid());
+    DatabaseManager::instance().setDatabasePath(m_dir.filePath("task_database.db"));
+    QVERIFY(DatabaseManager::instance().init());
+}
+
+void tst_DatabaseManager::initTwiceKeepsStore()
+{
+    // 重复初始化不重新迁移和装载内存仓库
+    DatabaseManager& db = DatabaseManager::instance();
+    const quint64 version = db.dataVersion();
+    QVERIFY(db.init());
+    QCOMPARE(db.dataVersion(), version);
+}
+
+void tst_DatabaseManager::writeUpdatesStoreAfterCommit()
+{
+    DatabaseManager& db = DatabaseManager::instance();
+    QSignalSpy spy(db.changeNotifier(), &TaskChangeNotifier::tasksChanged);
+
+    int taskId = -1;
+    QVERIFY(db.addTask(makeTask("单独写入"), &taskId));
+    QVERIFY(taskId > 0);
+    QVERIFY(storeContains(taskId));
+    QCOMPARE(spy.count(), 1);
+
+    Task task = db.getTaskById(taskId);
+    task.title = "单独写入（已修改）";
+    QVERIFY(db.updateTask(task));
+    QCOMPARE(db.getTaskById(taskId).title, task.title);
+
+    QVERIFY(db.deleteTask(taskId));
+    QVERIFY(!storeContains(taskId));
+    QCOMPARE(spy.count(), 3);
+}
+
+void tst_DatabaseManager::updateOfDeletedTaskFails()
+{
+    DatabaseManager& db = DatabaseManager::instance();
+    int taskId = -1;
+    QVERIFY(db.addTask(makeTask("将被删除"), &taskId));
+    Task task = db.getTaskById(taskId);
+    QVERIFY(db.deleteTask(taskId));
+
+    // 与删除并发的更新：没有行被更新，不发布变更，任务不会回到内存仓库
+    QSignalSpy spy(db.changeNotifier(), &TaskChangeNotifier::tasksChanged);
+    task.title = "删除后更新";
+    QVERIFY(!db.updateTask(task));
+    QVERIFY(!storeContains(taskId));
+    QCOMPARE(spy.count(), 0);
+}
+
+void tst_DatabaseManager::transactionDefersStoreUntilCommit()
+{
+    DatabaseManager& db = DatabaseManager::instance();
+    QSignalSpy spy(db.changeNotifier(), &TaskChangeNotifier::tasksChanged);
+    const quint64 version = db.dataVersion();
+
+    int taskId = -1;
+    {
+        DatabaseManager::TransactionGuard transaction;
+        QVERIFY(transaction.isActive());
+        QVERIFY(db.addTask(makeTask("事务内新增"), &taskId));
+        QVERIFY(db.addTagsForTask(taskId, QStringList() << "测试"));
+
+        // 提交前其他读取看不到未提交的写入
+        QVERIFY(!storeContains(taskId));
+        QCOMPARE(db.dataVersion(), version);
+        QCOMPARE(spy.count(), 0);
+
+        QVERIFY(transaction.commit());
+    }
+
+    QVERIFY(storeContains(taskId));
+    QCOMPARE(spy.count(), 1);
+    const QList<TaskChange> changes = spy.first().first().value<QList<TaskChange>>();
+    QCOMPARE(changes.count(), 2);
+    QCOMPARE(changes.at(1).type, TaskChange::TagsChanged);
+    QCOMPARE(changes.at(1).task.id, taskId); // 标签变更应用后补上任务
+}
+
+void tst_DatabaseManager::rollbackDiscardsPendingChanges()
+{
+    DatabaseManager& db = DatabaseManager::instance();
+    QSignalSpy spy(db.changeNotifier(), &TaskChangeNotifier::tasksChanged);
+    const quint64 version = db.dataVersion();
+    const int activeCount = db.getAllTasks().count();
+
+    int taskId = -1;
+    {
+        DatabaseManager::TransactionGuard transaction;
+        QVERIFY(db.addTask(makeTask("将被回滚"), &taskId));
+        // 未提交即离开作用域：自动回滚
+    }
+
+    QVERIFY(!storeContains(taskId));
+    QCOMPARE(db.getAllTasks().count(), activeCount);
+    QCOMPARE(db.dataVersion(), version); // 回滚不重新装载内存仓库
+    QCOMPARE(spy.count(), 0);
+}
+
+void tst_DatabaseManager::savepointRollbackKeepsOuterChanges()
+{
+    DatabaseManager& db = DatabaseManager::instance();
+    QSignalSpy spy(db.changeNotifier(), &TaskChangeNotifier::tasksChanged);
+
+    int outerId = -1;
+    int innerId = -1;
+    {
+        DatabaseManager::TransactionGuard outer;
+        QVERIFY(db.addTask(makeTask("外层"), &outerId));
+        {
+            DatabaseManager::TransactionGuard inner;
+            QVERIFY(inner.isActive());
+            QVERIFY(db.addTask(makeTask("内层"), &innerId));
+            inner.rollback();
+        }
+        QVERIFY(outer.commit());
+    }
+
+    QVERIFY(storeContains(outerId));
+    QVERIFY(!storeContains(innerId));
+    QCOMPARE(spy.count(), 1);
+    QCOMPARE(spy.first().first().value<QList<TaskChange>>().count(), 1);
+}
+
+void tst_DatabaseManager::archiveReportsArchivedTasks()
+{
+    DatabaseManager& db = DatabaseManager::instance();
+    int completedId = -1;
+    int uncompletedId = -1;
+    QVERIFY(db.addTask(makeTask("已完成", StatusCompleted), &completedId));
+    QVERIFY(db.addTask(makeTask("未完成"), &uncompletedId));
+
+    QSignalSpy spy(db.changeNotifier(), &TaskChangeNotifier::tasksChanged);
+    QVERIFY(db.archiveCompletedTasks());
+    QCOMPARE(spy.count(), 1);
+
+    bool reported = false;
+    for (const TaskChange& change : spy.first().first().value<QList<TaskChange>>()) {
+        QCOMPARE(change.type, TaskChange::Archived);
+        QVERIFY(change.taskId != uncompletedId);
+        QCOMPARE(change.task.is_archived, quint8(1));
+        if (change.taskId == completedId) reported = true;
+    }
+    QVERIFY(reported);
+    QCOMPARE(db.getTaskById(completedId).is_archived, quint8(1));
+    QCOMPARE(db.getTaskById(uncompletedId).is_archived, quint8(0));
+}
+
+void tst_DatabaseManager::emptyTagListClearsTags()
+{
+    DatabaseManager& db = DatabaseManager::instance();
+    int taskId = -1;
+    QVERIFY(db.addTask(makeTask("清除标签"), &taskId));
+    QVERIFY(db.addTagsForTask(taskId, QStringList() << "甲" << "乙"));
+    QCOMPARE(db.getTagsForTask(taskId).count(), 2);
+
+    QVERIFY(db.addTagsForTask(taskId, QStringList()));
+    QVERIFY(db.getTagsForTask(taskId).isEmpty());
+    QVERIFY(!db.addTagsForTask(-1, QStringList()));
+}
+
+void tst_DatabaseManager::tagsForTasksInOneQuery()
+{
+    DatabaseManager& db = DatabaseManager::instance();
+    int taggedId = -1;
+    int untaggedId = -1;
+    QVERIFY(db.addTask(makeTask("有标签"), &taggedId));
+    QVERIFY(db.addTask(makeTask("无标签"), &untaggedId));
+    QVERIFY(db.addTagsForTask(taggedId, QStringList() << "甲" << "乙"));
+
+    const QHash<int, QStringList> tags = db.getTagsForTasks(QVector<int>() << taggedId << untaggedId);
+    QStringList taggedTags = tags.value(taggedId);
+    taggedTags.sort();
+    QCOMPARE(taggedTags, QStringList() << "乙" << "甲");
+    QVERIFY(!tags.contains(untaggedId)); // 没有标签的任务不出现在结果中
+    QVERIFY(db.getTagsForTasks(QVector<int>()).isEmpty());
+}
+
+void tst_DatabaseManager::bulkInsert_data()
+{
+    QTest::addColumn<bool>("batched");
+    QTest::newRow("逐条提交") << false;
+    QTest::newRow("单一事务") << true;
+}
+
+void tst_DatabaseManager::bulkInsert()
+{
+    // 对比逐条提交与addTasks()一次提交写入1000个任务的耗时
+    QFETCH(bool, batched);
+    DatabaseManager& db = DatabaseManager::instance();
+    QList<Task> tasks;
+    for (int i = 0; i < 1000; ++i) {
+        tasks.append(makeTask(QString("批量任务%1").arg(i)));
+    }
+
+    const int activeCount = db.getAllTasks().count();
+    QBENCHMARK_ONCE {
+        if (batched) {
+            QVERIFY(db.addTasks(tasks));
+        } else {
+            for (const Task& task : tasks) {
+                QVERIFY(db.addTask(task));
+            }
+        }
+    }
+    QCOMPARE(db.getAllTasks().count(), activeCount + tasks.count());
+}
+
+QTEST_GUILESS_MAIN(tst_DatabaseManager)
+
+#include "tst_databasemanager.moc"
@@ -0,0 +1,64 @@
+#include <QtTest>
+#include "deadlinequeue.h"
+
+// 截止时间堆：每个任务只保留最后一次安排，取消与改期留下的旧条目不会被取出
+class tst_DeadlineQueue : public QObject
+{
+    Q_OBJECT
+
+private slots:
+    void takesInTimeOrder();
+    void rescheduleAndCancel();
+    void compactionKeepsValidEntries();
+};
+
+void tst_DeadlineQueue::takesInTimeOrder()
+{
+    DeadlineQueue queue;
+    QCOMPARE(queue.nextDeadline(), qint64(-1));
+    queue.schedule(1, 300);
+    queue.schedule(2, 100);
+    queue.schedule(3, 200);
+    QCOMPARE(queue.count(), 3);
+    QCOMPARE(queue.nextDeadline(), qint64(100));
+
+    QCOMPARE(queue.takeUntil(99), QVector<int>());
+    QCOMPARE(queue.takeUntil(200), QVector<int>() << 2 << 3); // 包含等于limitMs的条目
+    QVERIFY(!queue.contains(2));
+    QCOMPARE(queue.nextDeadline(), qint64(300));
+    QCOMPARE(queue.takeUntil(1000), QVector<int>() << 1);
+    QCOMPARE(queue.count(), 0);
+}
+
+void tst_DeadlineQueue::rescheduleAndCancel()
+{
+    DeadlineQueue queue;
+    queue.schedule(1, 100);
+    queue.schedule(1, 500); // 改期推后：旧条目作废
+    queue.schedule(2, 200);
+    QVERIFY(queue.cancel(2));
+    QVERIFY(!queue.cancel(2));
+    QCOMPARE(queue.count(), 1);
+
+    QCOMPARE(queue.nextDeadline(), qint64(500));
+    QCOMPARE(queue.takeUntil(400), QVector<int>());
+    QCOMPARE(queue.takeUntil(500), QVector<int>() << 1);
+
+    queue.schedule(3, 100);
+    queue.clear();
+    QCOMPARE(queue.nextDeadline(), qint64(-1));
+}
+
+void tst_DeadlineQueue::compactionKeepsValidEntries()
+{
+    DeadlineQueue queue;
+    for (int i = 0; i < 10000; ++i) {
+        queue.schedule(i % 3, 10000 - i); // 反复改期，留下大量作废条目
+    }
+    QCOMPARE(queue.count(), 3);
+    QCOMPARE(queue.takeUntil(100000), QVector<int>() << 0 << 2 << 1);
+}
+
+QTEST_APPLESS_MAIN(tst_DeadlineQueue)
+
+#include "tst_deadlinequeue.moc"
@@ -0,0 +1,7 @@
+include(../tests.pri)
+
+TARGET = tst_deadlinequeue
+
+SOURCES += \
+    tst_deadlinequeue.cpp \
+    $$APP_DIR/deadlinequeue.cpp
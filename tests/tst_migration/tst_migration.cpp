@@ -0,0 +1,204 @@
+#include <QtTest>
+#include <QTemporaryDir>
+#include <QSqlDatabase>
+#include <QSqlQuery>
+#include <QSqlError>
+#include "databasemanager.h"
+
+// 表结构迁移：按最早版本的表结构（无user_version、文本时间、tags表）建库，init()后逐项检查各版本的结果
+class tst_Migration : public QObject
+{
+    Q_OBJECT
+
+private slots:
+    void initTestCase();
+    void cleanupTestCase();
+    void reachesLatestVersion();
+    void v1AddsMissingColumns();
+    void v2MovesTagsToDictionary();
+    void v3ConvertsTimesToEpochMs();
+    void v4SearchIndexWithoutTriggers();
+    void v5CountersMatchTasks();
+    void v6AlertLogFollowsDeletes();
+    void searchIndexBuiltFromMigratedData();
+
+private:
+    QStringList names(const QString& sql);
+    QVariant scalar(const QString& sql);
+
+    QTemporaryDir m_dir;
+    QSqlDatabase m_check; // 检查用的独立连接
+};
+
+QStringList tst_Migration::names(const QString& sql)
+{
+    QStringList result;
+    QSqlQuery query(m_check);
+    if (!query.exec(sql)) qWarning() << query.lastError().text();
+    while (query.next()) {
+        result.append(query.value(0).toString());
+    }
+    return result;
+}
+
+QVariant tst_Migration::scalar(const QString& sql)
+{
+    QSqlQuery query(m_check);
+    if (!query.exec(sql) || !query.next()) {
+        qWarning() << query.lastError().text();
+        return QVariant();
+    }
+    return query.value(0);
+}
+
+void tst_Migration::initTestCase()
+{
+    QVERIFY(m_dir.isValid());
+    const QString path = m_dir.filePath("task_database.db");
+
+    {
+        QSqlDatabase legacy = QSqlDatabase::addDatabase("QSQLITE", "legacy");
+        legacy.setDatabaseName(path);
+        QVERIFY(legacy.open());
+        QSqlQuery query(legacy);
+        const QStringList statements = {
+            R"(CREATE TABLE tasks (
+                   id INTEGER PRIMARY KEY AUTOINCREMENT,
+                   title TEXT NOT NULL,
+                   category TEXT NOT NULL,
+                   priority TEXT NOT NULL,
+                   due_time DATETIME NOT NULL,
+                   status INTEGER NOT NULL DEFAULT 0,
+                   description TEXT
+               ))",
+            R"(CREATE TABLE tags (
+                   id INTEGER PRIMARY KEY AUTOINCREMENT,
+                   task_id INTEGER NOT NULL,
+                   tag_name TEXT NOT NULL
+               ))",
+            "INSERT INTO tasks (id, title, category, priority, due_time, status, description) "
+            "VALUES (1, '编写周报', '工作', '高', '2024-01-02 03:04:05', 0, 'Weekly Report')",
+            "INSERT INTO tasks (id, title, category, priority, due_time, status, description) "
+            "VALUES (2, '复习', '学习', '低', '2030-06-01 08:00:00', 1, '')",
+            // 首尾空白、空标签与已删除任务遗留的标签
+            "INSERT INTO tags (task_id, tag_name) VALUES (1, ' 工作 '), (1, 'Qt'), (2, 'Qt'), (2, '  '), (99, '孤立')",
+        };
+        for (const QString& sql : statements) {
+            QVERIFY2(query.exec(sql), qPrintable(query.lastError().text()));
+        }
+        legacy.close();
+    }
+    QSqlDatabase::removeDatabase("legacy");
+
+    DatabaseManager& db = DatabaseManager::instance();
+    db.setDatabasePath(path);
+    QVERIFY(db.init());
+
+    m_check = QSqlDatabase::addDatabase("QSQLITE", "check");
+    m_check.setDatabaseName(path);
+    QVERIFY(m_check.open());
+}
+
+void tst_Migration::cleanupTestCase()
+{
+    m_check.close();
+    m_check = QSqlDatabase();
+    QSqlDatabase::removeDatabase("check");
+}
+
+void tst_Migration::reachesLatestVersion()
+{
+    QCOMPARE(scalar("PRAGMA user_version").toInt(), 6);
+}
+
+void tst_Migration::v1AddsMissingColumns()
+{
+    const QStringList columns = names("SELECT name FROM pragma_table_info('tasks')");
+    QVERIFY(columns.contains("is_archived"));
+    QVERIFY(columns.contains("progress"));
+    QVERIFY(columns.contains("remind_time"));
+
+    const Task task = DatabaseManager::instance().getTaskById(1);
+    QCOMPARE(task.title, QString("编写周报"));
+    QCOMPARE(task.is_archived, quint8(0));
+    QCOMPARE(task.progress, quint8(0));
+    QVERIFY(!task.remindTime.isValid());
+}
+
+void tst_Migration::v2MovesTagsToDictionary()
+{
+    QVERIFY(!names("SELECT name FROM sqlite_master WHERE type = 'table'").contains("tags"));
+    // 标签去除首尾空白后驻留一次，空标签与孤立标签不迁移
+    QCOMPARE(names("SELECT name FROM tag ORDER BY name"), QStringList() << "Qt" << "工作");
+    QCOMPARE(scalar("SELECT COUNT(*) FROM task_tag").toInt(), 3);
+
+    DatabaseManager& db = DatabaseManager::instance();
+    QStringList tags = db.getTagsForTask(1);
+    tags.sort();
+    QCOMPARE(tags, QStringList() << "Qt" << "工作");
+    QCOMPARE(db.getTagsForTask(2), QStringList() << "Qt");
+}
+
+void tst_Migration::v3ConvertsTimesToEpochMs()
+{
+    // 文本时间按本地时间解释后存为毫秒时间戳
+    QCOMPARE(scalar("SELECT typeof(due_time) FROM tasks WHERE id = 1").toString(), QString("integer"));
+    const QDateTime expected = QDateTime::fromString("2024-01-02 03:04:05", "yyyy-MM-dd HH:mm:ss");
+    QCOMPARE(DatabaseManager::instance().getTaskById(1).dueTime, expected);
+    QVERIFY(names("SELECT name FROM sqlite_master WHERE type = 'index'").contains("idx_tasks_archived_status_due"));
+}
+
+void tst_Migration::v4SearchIndexWithoutTriggers()
+{
+    // task_search由应用同步，不建立触发器；不支持FTS5时只有过期标记
+    const QStringList tables = names("SELECT name FROM sqlite_master WHERE type = 'table'");
+    QVERIFY(tables.contains("task_search") != tables.contains("task_search_stale"));
+    QVERIFY(names("SELECT name FROM sqlite_master WHERE type = 'trigger' AND sql LIKE '%task_search%'").isEmpty());
+}
+
+void tst_Migration::v5CountersMatchTasks()
+{
+    QCOMPARE(scalar("SELECT SUM(count) FROM task_counters").toInt(), 2);
+    const TaskStats stats = DatabaseManager::instance().getTaskStats();
+    QCOMPARE(stats.total, 2);
+    QCOMPARE(stats.completed, 1);
+    QCOMPARE(stats.overdue, 1); // 任务1的截止时间已过
+    QCOMPARE(stats.byCategory[CategoryWork], 1);
+    QCOMPARE(stats.byCategory[CategoryStudy], 1);
+}
+
+void tst_Migration::v6AlertLogFollowsDeletes()
+{
+    DatabaseManager& db = DatabaseManager::instance();
+    Task task;
+    task.title = "待删除";
+    task.category = CategoryOther;
+    task.priority = PriorityMedium;
+    task.dueTime = QDateTime::currentDateTime();
+    int taskId = -1;
+    QVERIFY(db.addTask(task, &taskId));
+
+    QSqlQuery query(m_check);
+    QVERIFY(query.exec(QString("INSERT INTO task_alert_log (task_id, kind, at_ms, notified_at) VALUES (%1, 0, 0, 0)")
+                           .arg(taskId)));
+    QVERIFY(db.deleteTask(taskId));
+    QCOMPARE(scalar(QString("SELECT COUNT(*) FROM task_alert_log WHERE task_id = %1").arg(taskId)).toInt(), 0);
+    QCOMPARE(scalar("SELECT SUM(count) FROM task_counters").toInt(), 2);
+}
+
+void tst_Migration::searchIndexBuiltFromMigratedData()
+{
+    // 迁移前已有的任务也能按标题、备注与标签检索
+    DatabaseManager& db = DatabaseManager::instance();
+    for (const QString& keyword : {QString("周报"), QString("report"), QString("qt")}) {
+        bool found = false;
+        for (const TaskSearchHit& hit : db.searchTasks(keyword)) {
+            if (hit.task.id == 1) found = true;
+        }
+        QVERIFY2(found, qPrintable(keyword));
+    }
+}
+
+QTEST_GUILESS_MAIN(tst_Migration)
+
+#include "tst_migration.moc"
@@ -0,0 +1,20 @@
+include(../tests.pri)
+
+QT += sql concurrent
+
+TARGET = tst_migration
+
+SOURCES += \
+    tst_migration.cpp \
+    $$APP_DIR/connectionpool.cpp \
+    $$APP_DIR/databasemanager.cpp \
+    $$APP_DIR/task.cpp \
+    $$APP_DIR/taskchangenotifier.cpp \
+    $$APP_DIR/taskcolumns.cpp \
+    $$APP_DIR/taskquery.cpp \
+    $$APP_DIR/taskstore.cpp
+
+HEADERS += \
+    $$APP_DIR/connectionpool.h \
+    $$APP_DIR/databasemanager.h \
+    $$APP_DIR/taskchangenotifier.h
@@ -0,0 +1,130 @@
+#include <QtTest>
+#include <QDateTime>
+#include <QElapsedTimer>
+#include "reminderscheduler.h"
+
+// 提醒调度器：按时触发、改期只保留最后一次、取消、相近提醒合并为一批、作废条目过多时重建堆
+class tst_ReminderScheduler : public QObject
+{
+    Q_OBJECT
+
+private slots:
+    void firesAtScheduledTime();
+    void pastReminderFiresImmediately();
+    void rescheduleKeepsLatest();
+    void cancelAndClear();
+    void nearbyRemindersFireTogether();
+    void manyReschedulesFireOnce();
+
+private:
+    static qint64 now() { return QDateTime::currentMSecsSinceEpoch(); }
+    static QList<int> firedIds(const QSignalSpy& spy, int batch);
+};
+
+QList<int> tst_ReminderScheduler::firedIds(const QSignalSpy& spy, int batch)
+{
+    QList<int> ids = spy.at(batch).first().value<QList<int>>();
+    std::sort(ids.begin(), ids.end());
+    return ids;
+}
+
+void tst_ReminderScheduler::firesAtScheduledTime()
+{
+    ReminderScheduler scheduler;
+    QSignalSpy spy(&scheduler, &ReminderScheduler::remindersDue);
+    QElapsedTimer elapsed;
+    elapsed.start();
+    scheduler.schedule(1, now() + 200);
+    QVERIFY(scheduler.isScheduled(1));
+
+    QVERIFY(spy.wait(2000));
+    QVERIFY(elapsed.elapsed() >= 190);
+    QCOMPARE(firedIds(spy, 0), QList<int>() << 1);
+    QVERIFY(!scheduler.isScheduled(1));
+    QCOMPARE(scheduler.pendingCount(), 0);
+}
+
+void tst_ReminderScheduler::pastReminderFiresImmediately()
+{
+    ReminderScheduler scheduler;
+    QSignalSpy spy(&scheduler, &ReminderScheduler::remindersDue);
+    scheduler.schedule(1, now() - 60 * 1000);
+    QVERIFY(spy.wait(500));
+    QCOMPARE(firedIds(spy, 0), QList<int>() << 1);
+}
+
+void tst_ReminderScheduler::rescheduleKeepsLatest()
+{
+    ReminderScheduler scheduler;
+    QSignalSpy spy(&scheduler, &ReminderScheduler::remindersDue);
+    scheduler.schedule(1, now() + 60 * 1000);
+    scheduler.schedule(1, now() + 50); // 改期提前
+    scheduler.schedule(2, now() + 50);
+    scheduler.schedule(2, now() + 60 * 1000); // 改期推后
+    QCOMPARE(scheduler.pendingCount(), 2);
+
+    QVERIFY(spy.wait(2000));
+    QCOMPARE(firedIds(spy, 0), QList<int>() << 1);
+    QVERIFY(scheduler.isScheduled(2));
+
+    // 任务1的旧条目出堆时被丢弃，不再触发
+    QTest::qWait(700);
+    QCOMPARE(spy.count(), 1);
+}
+
+void tst_ReminderScheduler::cancelAndClear()
+{
+    ReminderScheduler scheduler;
+    QSignalSpy spy(&scheduler, &ReminderScheduler::remindersDue);
+    scheduler.schedule(1, now() + 50);
+    scheduler.schedule(2, now() + 50);
+    scheduler.cancel(1);
+    scheduler.cancel(3); // 未安排的任务
+    QCOMPARE(scheduler.pendingCount(), 1);
+
+    QVERIFY(spy.wait(2000));
+    QCOMPARE(firedIds(spy, 0), QList<int>() << 2);
+
+    scheduler.schedule(4, now() + 50);
+    scheduler.clear();
+    QCOMPARE(scheduler.pendingCount(), 0);
+    QVERIFY(!spy.wait(300));
+}
+
+void tst_ReminderScheduler::nearbyRemindersFireTogether()
+{
+    ReminderScheduler scheduler;
+    QSignalSpy spy(&scheduler, &ReminderScheduler::remindersDue);
+    const qint64 base = now() + 100;
+    scheduler.schedule(1, base);
+    scheduler.schedule(2, base + 200); // 在合并窗口内
+    scheduler.schedule(3, base + 1500); // 在合并窗口外
+
+    QVERIFY(spy.wait(2000));
+    QCOMPARE(firedIds(spy, 0), QList<int>() << 1 << 2);
+    QVERIFY(spy.wait(3000));
+    QCOMPARE(firedIds(spy, 1), QList<int>() << 3);
+}
+
+void tst_ReminderScheduler::manyReschedulesFireOnce()
+{
+    // 反复改期留下大量作废条目，超过阈值后按有效提醒重建堆
+    ReminderScheduler scheduler;
+    QSignalSpy spy(&scheduler, &ReminderScheduler::remindersDue);
+    const qint64 far = now() + 60 * 60 * 1000;
+    for (int i = 0; i < 5000; ++i) {
+        scheduler.schedule(1 + i % 2, far + i);
+    }
+    scheduler.schedule(1, now() + 50);
+    QCOMPARE(scheduler.pendingCount(), 2);
+
+    QVERIFY(spy.wait(2000));
+    QCOMPARE(firedIds(spy, 0), QList<int>() << 1);
+    QVERIFY(scheduler.isScheduled(2));
+    QTest::qWait(200);
+    QCOMPARE(spy.count(), 1);
+}
+
+QTEST_GUILESS_MAIN(tst_ReminderScheduler)
+
+#include "tst_reminderscheduler.moc"
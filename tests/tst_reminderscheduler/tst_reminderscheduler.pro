@@ -0,0 +1,11 @@
+include(../tests.pri)
+
+TARGET = tst_reminderscheduler
+
+SOURCES += \
+    tst_reminderscheduler.cpp \
+    $$APP_DIR/deadlinequeue.cpp \
+    $$APP_DIR/reminderscheduler.cpp
+
+HEADERS += \
+    $$APP_DIR/reminderscheduler.h
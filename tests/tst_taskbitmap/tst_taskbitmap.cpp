@@ -0,0 +1,197 @@
+#include <QtTest>
+#include <algorithm>
+#include <functional>
+#include "taskbitmap.h"
+
+// 压缩位图：块在4096个元素处于有序数组与位图之间切换，集合运算与倒序遍历的结果与逐个判断一致
+class tst_TaskBitmap : public QObject
+{
+    Q_OBJECT
+
+private slots:
+    void switchesToWordsAboveArrayLimit();
+    void switchesBackToArrayAfterRemoval();
+    void setOperationsAcrossContainerKinds_data();
+    void setOperationsAcrossContainerKinds();
+    void forEachDescendingAcrossContainers();
+    void forEachDescendingBelow_data();
+    void forEachDescendingBelow();
+    void forEachDescendingStopsEarly();
+    void countAboveAndValueAtDescending_data();
+    void countAboveAndValueAtDescending();
+
+private:
+    static TaskBitmap makeBitmap(int first, int count, int step);
+    static QVector<int> expected(int limit, const std::function<bool(int)>& predicate);
+};
+
+TaskBitmap tst_TaskBitmap::makeBitmap(int first, int count, int step)
+{
+    TaskBitmap bitmap;
+    for (int i = 0; i < count; ++i) {
+        bitmap.add(first + i * step);
+    }
+    return bitmap;
+}
+
+QVector<int> tst_TaskBitmap::expected(int limit, const std::function<bool(int)>& predicate)
+{
+    // [0, limit)内逐个判断得到的倒序结果，作为参照
+    QVector<int> values;
+    for (int value = limit - 1; value >= 0; --value) {
+        if (predicate(value)) values.append(value);
+    }
+    return values;
+}
+
+void tst_TaskBitmap::switchesToWordsAboveArrayLimit()
+{
+    // 同一块（高16位为0）中的偶数：4096个以内为数组，第4097个起转为位图
+    TaskBitmap bitmap = makeBitmap(0, 4096, 2);
+    QCOMPARE(bitmap.count(), 4096);
+    bitmap.add(2 * 4096);
+    QCOMPARE(bitmap.count(), 4097);
+    bitmap.add(2 * 4096); // 重复添加不改变计数
+    QCOMPARE(bitmap.count(), 4097);
+
+    for (int value = 0; value <= 2 * 4096 + 1; ++value) {
+        QCOMPARE(bitmap.contains(value), value % 2 == 0);
+    }
+    QCOMPARE(bitmap.toDescendingVector().first(), 2 * 4096);
+    QCOMPARE(bitmap.toDescendingVector().last(), 0);
+}
+
+void tst_TaskBitmap::switchesBackToArrayAfterRemoval()
+{
+    TaskBitmap bitmap = makeBitmap(0, 5000, 2);
+    for (int i = 0; i < 1000; ++i) {
+        bitmap.remove(i * 2);
+    }
+    bitmap.remove(1); // 不存在的值
+    QCOMPARE(bitmap.count(), 4000);
+    QVERIFY(!bitmap.contains(0));
+    QVERIFY(bitmap.contains(2000));
+    QVERIFY(bitmap.contains(2 * 4999));
+
+    for (int i = 1000; i < 5000; ++i) {
+        bitmap.remove(i * 2);
+    }
+    QVERIFY(bitmap.isEmpty());
+    QCOMPARE(bitmap.toDescendingVector(), QVector<int>());
+}
+
+void tst_TaskBitmap::setOperationsAcrossContainerKinds_data()
+{
+    QTest::addColumn<int>("countA");
+    QTest::addColumn<int>("countB");
+
+    QTest::newRow("数组与数组") << 100 << 300;
+    QTest::newRow("数组与位图") << 100 << 6000;
+    QTest::newRow("位图与位图") << 5000 << 6000;
+    QTest::newRow("位图求交后转为数组") << 9000 << 9000;
+}
+
+void tst_TaskBitmap::setOperationsAcrossContainerKinds()
+{
+    QFETCH(int, countA);
+    QFETCH(int, countB);
+    // a为3的倍数，b为2的倍数，都跨越两个块
+    const TaskBitmap a = makeBitmap(0, countA, 3) | makeBitmap(70000, countA, 3);
+    const TaskBitmap b = makeBitmap(0, countB, 2) | makeBitmap(70000, countB, 2);
+    const int limit = 70000 + 3 * qMax(countA, countB);
+    auto inA = [&](int v) { return (v < 3 * countA && v % 3 == 0)
+                                   || (v >= 70000 && v < 70000 + 3 * countA && (v - 70000) % 3 == 0); };
+    auto inB = [&](int v) { return (v < 2 * countB && v % 2 == 0)
+                                   || (v >= 70000 && v < 70000 + 2 * countB && (v - 70000) % 2 == 0); };
+
+    const QVector<int> intersection = expected(limit, [&](int v) { return inA(v) && inB(v); });
+    QCOMPARE((a & b).toDescendingVector(), intersection);
+    QCOMPARE(a.intersectionCount(b), intersection.count());
+    QCOMPARE((a | b).toDescendingVector(), expected(limit, [&](int v) { return inA(v) || inB(v); }));
+    QCOMPARE(a.andNot(b).toDescendingVector(), expected(limit, [&](int v) { return inA(v) && !inB(v); }));
+}
+
+void tst_TaskBitmap::forEachDescendingAcrossContainers()
+{
+    TaskBitmap bitmap;
+    bitmap.add(5);
+    bitmap.add(65535);
+    bitmap.add(65536);
+    bitmap.add(3 * 65536 + 7);
+    QCOMPARE(bitmap.toDescendingVector(), QVector<int>() << 3 * 65536 + 7 << 65536 << 65535 << 5);
+}
+
+void tst_TaskBitmap::forEachDescendingBelow_data()
+{
+    QTest::addColumn<int>("count");
+    QTest::addColumn<int>("below");
+
+    // 数组块与位图块各取块内、字边界、块边界与越界的起点
+    for (int count : {1000, 8000}) {
+        const QString kind = count > 4096 ? "位图" : "数组";
+        QTest::newRow(qPrintable(kind + "块内")) << count << 1001;
+        QTest::newRow(qPrintable(kind + "字边界")) << count << 64;
+        QTest::newRow(qPrintable(kind + "字边界后一位")) << count << 65;
+        QTest::newRow(qPrintable(kind + "块边界")) << count << 65536;
+        QTest::newRow(qPrintable(kind + "下一块内")) << count << 65536 + 10;
+        QTest::newRow(qPrintable(kind + "不大于最小值")) << count << 0;
+    }
+}
+
+void tst_TaskBitmap::forEachDescendingBelow()
+{
+    QFETCH(int, count);
+    QFETCH(int, below);
+    // 两个块中各count个奇数：count超过4096时为位图块
+    const TaskBitmap bitmap = makeBitmap(1, count, 2) | makeBitmap(65537, count, 2);
+    QVector<int> values;
+    QVERIFY(bitmap.forEachDescending([&](int value) {
+        values.append(value);
+        return true;
+    }, below));
+    QCOMPARE(values, expected(below, [&](int v) {
+        return v % 2 == 1 && ((v >= 1 && v < 1 + 2 * count) || (v >= 65537 && v < 65537 + 2 * count));
+    }));
+}
+
+void tst_TaskBitmap::forEachDescendingStopsEarly()
+{
+    const TaskBitmap bitmap = makeBitmap(0, 6000, 1);
+    QVector<int> values;
+    QVERIFY(!bitmap.forEachDescending([&](int value) {
+        values.append(value);
+        return values.count() < 3;
+    }));
+    QCOMPARE(values, QVector<int>() << 5999 << 5998 << 5997);
+}
+
+void tst_TaskBitmap::countAboveAndValueAtDescending_data()
+{
+    QTest::addColumn<int>("count");
+
+    QTest::newRow("数组块") << 1000;
+    QTest::newRow("位图块") << 8000;
+}
+
+void tst_TaskBitmap::countAboveAndValueAtDescending()
+{
+    QFETCH(int, count);
+    // 两个块中各count个奇数：倒序位置与逐个遍历得到的下标一致
+    const TaskBitmap bitmap = makeBitmap(1, count, 2) | makeBitmap(65537, count, 2);
+    const QVector<int> values = bitmap.toDescendingVector();
+    for (int rank = 0; rank < values.count(); rank += 37) {
+        QCOMPARE(bitmap.valueAtDescending(rank), values.at(rank));
+        QCOMPARE(bitmap.countAbove(values.at(rank)), rank);
+        QCOMPARE(bitmap.countAbove(values.at(rank) - 1), rank + 1); // 不在集合中的值
+    }
+    QCOMPARE(bitmap.valueAtDescending(values.count() - 1), 1);
+    QCOMPARE(bitmap.valueAtDescending(values.count()), -1);
+    QCOMPARE(bitmap.valueAtDescending(-1), -1);
+    QCOMPARE(bitmap.countAbove(0), values.count());
+    QCOMPARE(bitmap.countAbove(65535), count);
+    QCOMPARE(bitmap.countAbove(INT_MAX), 0);
+}
+
+QTEST_APPLESS_MAIN(tst_TaskBitmap)
+
+#include "tst_taskbitmap.moc"
@@ -0,0 +1,7 @@
+include(../tests.pri)
+
+TARGET = tst_taskbitmap
+
+SOURCES += \
+    tst_taskbitmap.cpp \
+    $$APP_DIR/taskbitmap.cpp
@@ -0,0 +1,152 @@
+#include <QtTest>
+#include <QTemporaryDir>
+#include <algorithm>
+#include <functional>
+#include "databasemanager.h"
+#include "taskpager.h"
+
+// 键集分页器：按ID倒序分页取归档任务，页被淘汰后按ID区间重新装入（只保留行数），标签随页批量装入
+class tst_TaskPager : public QObject
+{
+    Q_OBJECT
+
+private slots:
+    void initTestCase();
+    void pagesInDescendingIdOrder_data();
+    void pagesInDescendingIdOrder();
+    void evictedPageReloads();
+    void tagsLoadedPerPage();
+    void deletedRowShiftsWithinItsPage();
+
+private:
+    static void loadAll(TaskPager& pager);
+
+    QTemporaryDir m_dir;
+    QVector<int> m_archivedIds; // 归档任务ID（倒序）
+    int m_taggedId = -1;
+};
+
+void tst_TaskPager::loadAll(TaskPager& pager)
+{
+    pager.reset(TaskQuery().archived(true));
+    while (pager.canFetchMore()) {
+        pager.appendPage(pager.loadNextPage());
+    }
+}
+
+void tst_TaskPager::initTestCase()
+{
+    QVERIFY(m_dir.isValid());
+    DatabaseManager& db = DatabaseManager::instance();
+    db.setDatabasePath(m_dir.filePath("task_database.db"));
+    QVERIFY(db.init());
+
+    // 600个已完成任务与其间穿插的未完成任务；归档后只有已完成任务进入分页结果
+    QList<Task> tasks;
+    for (int i = 0; i < 800; ++i) {
+        Task task;
+        task.title = QString("任务%1").arg(i);
+        task.category = CategoryWork;
+        task.priority = PriorityLow;
+        task.status = (i % 4 == 3) ? StatusUncompleted : StatusCompleted;
+        task.dueTime = QDateTime::currentDateTime().addDays(1);
+        tasks.append(task);
+    }
+    QList<int> ids;
+    QVERIFY(db.addTasks(tasks, &ids));
+    for (int i = 0; i < ids.count(); ++i) {
+        if (tasks.at(i).status == StatusCompleted) m_archivedIds.append(ids.at(i));
+    }
+    std::sort(m_archivedIds.begin(), m_archivedIds.end(), std::greater<int>());
+    QCOMPARE(m_archivedIds.count(), 600);
+
+    m_taggedId = m_archivedIds.at(300);
+    QVERIFY(db.addTagsForTask(m_taggedId, QStringList() << "归档" << "测试"));
+    QVERIFY(db.archiveCompletedTasks());
+}
+
+void tst_TaskPager::pagesInDescendingIdOrder_data()
+{
+    QTest::addColumn<int>("pageSize");
+    QTest::addColumn<int>("pageCount");
+
+    QTest::newRow("最后一页不满") << 256 << 3;
+    // 恰好整页时还需取一次空页才知道已取完
+    QTest::newRow("恰好整页") << 300 << 2;
+}
+
+void tst_TaskPager::pagesInDescendingIdOrder()
+{
+    QFETCH(int, pageSize);
+    QFETCH(int, pageCount);
+
+    TaskPager pager(pageSize, 16);
+    pager.reset(TaskQuery().archived(true));
+    for (int page = 0; page < pageCount; ++page) {
+        QVERIFY(pager.canFetchMore());
+        const QList<Task> tasks = pager.loadNextPage();
+        QCOMPARE(tasks.count(), qMin(pageSize, m_archivedIds.count() - page * pageSize));
+        pager.appendPage(tasks);
+    }
+    if (pager.canFetchMore()) {
+        const QList<Task> tasks = pager.loadNextPage();
+        QVERIFY(tasks.isEmpty());
+        pager.appendPage(tasks);
+    }
+    QVERIFY(!pager.canFetchMore());
+
+    QCOMPARE(pager.rowCount(), m_archivedIds.count());
+    for (int row = 0; row < pager.rowCount(); ++row) {
+        QCOMPARE(pager.taskAt(row)->id, m_archivedIds.at(row));
+    }
+    QVERIFY(!pager.taskAt(-1));
+    QVERIFY(!pager.taskAt(pager.rowCount()));
+}
+
+void tst_TaskPager::evictedPageReloads()
+{
+    // 只常驻一页：访问其他页后第一页被淘汰，再次访问时按ID区间重新查询
+    TaskPager pager(100, 1);
+    loadAll(pager);
+    const Task first = *pager.taskAt(0);
+    const Task last = *pager.taskAt(pager.rowCount() - 1);
+    QCOMPARE(pager.taskAt(0)->id, first.id);
+    QCOMPARE(pager.taskAt(0)->title, first.title);
+    QCOMPARE(pager.taskAt(pager.rowCount() - 1)->title, last.title);
+    QCOMPARE(pager.taskAt(250)->id, m_archivedIds.at(250));
+}
+
+void tst_TaskPager::tagsLoadedPerPage()
+{
+    TaskPager pager(100, 1);
+    loadAll(pager);
+    const int row = m_archivedIds.indexOf(m_taggedId);
+    QStringList tags = pager.tagsAt(row);
+    tags.sort();
+    QCOMPARE(tags, QStringList() << "归档" << "测试");
+    QVERIFY(pager.tagsAt(row + 1).isEmpty());
+    pager.tagsAt(0); // 淘汰该页的标签后重新装入
+    QCOMPARE(pager.tagsAt(row).count(), 2);
+    QVERIFY(pager.tagsAt(pager.rowCount()).isEmpty());
+}
+
+void tst_TaskPager::deletedRowShiftsWithinItsPage()
+{
+    // 取页之后删除的任务：所在页重新装入时其后的行在页内前移，页尾以空任务补齐，其他页的行号不变
+    TaskPager pager(100, 1);
+    loadAll(pager);
+    QVERIFY(DatabaseManager::instance().deleteTaskPermanently(m_archivedIds.at(10)));
+    pager.taskAt(pager.rowCount() - 1); // 淘汰第一页
+
+    QCOMPARE(pager.rowCount(), m_archivedIds.count());
+    QCOMPARE(pager.taskAt(10)->id, m_archivedIds.at(11));
+    QCOMPARE(pager.taskAt(98)->id, m_archivedIds.at(99));
+    QCOMPARE(pager.taskAt(99)->id, -1);
+    QVERIFY(pager.tagsAt(99).isEmpty());
+    QCOMPARE(pager.taskAt(100)->id, m_archivedIds.at(100));
+    QVERIFY(!pager.taskAt(100)->title.isEmpty());
+}
+
+QTEST_GUILESS_MAIN(tst_TaskPager)
+
+#include "tst_taskpager.moc"
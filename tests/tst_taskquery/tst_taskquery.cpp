@@ -0,0 +1,187 @@
+#include <QtTest>
+#include "taskquery.h"
+
+// TaskQuery的SQL生成、关键词分词与全文检索表达式（纯逻辑，不访问数据库）
+class tst_TaskQuery : public QObject
+{
+    Q_OBJECT
+
+private slots:
+    void toSqlDefaults();
+    void toSqlAllConditions();
+    void toSqlStatusConditions_data();
+    void toSqlStatusConditions();
+    void toSqlKeyword();
+    void toSqlShapeIndependentOfValues();
+    void searchTerms_data();
+    void searchTerms();
+    void ftsDocument_data();
+    void ftsDocument();
+    void ftsMatchExpression_data();
+    void ftsMatchExpression();
+    void likeCondition();
+    void searchSnippet();
+};
+
+void tst_TaskQuery::toSqlDefaults()
+{
+    QVariantMap bindings;
+    QCOMPARE(TaskQuery().toSql("t.id", &bindings),
+             QString("SELECT t.id FROM tasks t WHERE t.is_archived = :archived ORDER BY t.id DESC"));
+    QCOMPARE(bindings.count(), 1);
+    QCOMPARE(bindings.value(":archived").toInt(), 0);
+}
+
+void tst_TaskQuery::toSqlAllConditions()
+{
+    QVariantMap bindings;
+    const QString sql = TaskQuery().archived(true).category(CategoryWork).priority(PriorityHigh)
+                            .tag("Qt").idRange(10, 20).limit(5).toSql("t.id", &bindings);
+
+    QVERIFY(sql.startsWith("SELECT t.id FROM tasks t WHERE t.is_archived = :archived AND "));
+    QVERIFY(sql.contains("t.category = :category"));
+    QVERIFY(sql.contains("t.priority = :priority"));
+    QVERIFY(sql.contains("t.id >= :min_id AND t.id < :before_id"));
+    QVERIFY(sql.endsWith("ORDER BY t.id DESC LIMIT :limit"));
+    // 标签名精确匹配，区分大小写
+    QVERIFY(sql.contains("g.name = :tag_name)"));
+    QVERIFY(!sql.contains("NOCASE"));
+
+    QCOMPARE(bindings.value(":archived").toInt(), 1);
+    QCOMPARE(bindings.value(":category").toString(), QString("工作"));
+    QCOMPARE(bindings.value(":priority").toString(), QString("高"));
+    QCOMPARE(bindings.value(":tag_name").toString(), QString("Qt"));
+    QCOMPARE(bindings.value(":min_id").toInt(), 10);
+    QCOMPARE(bindings.value(":before_id").toInt(), 20);
+    QCOMPARE(bindings.value(":limit").toInt(), 5);
+}
+
+void tst_TaskQuery::toSqlStatusConditions_data()
+{
+    QTest::addColumn<int>("status");
+    QTest::addColumn<QString>("condition");
+    QTest::addColumn<bool>("usesNow");
+
+    QTest::newRow("未完成") << int(TaskQuery::Uncompleted) << "t.status = 0 AND t.due_time >= :now_ms" << true;
+    QTest::newRow("已完成") << int(TaskQuery::Completed) << "t.status = 1" << false;
+    QTest::newRow("已超期") << int(TaskQuery::Overdue) << "t.status = 0 AND t.due_time < :now_ms" << true;
+}
+
+void tst_TaskQuery::toSqlStatusConditions()
+{
+    QFETCH(int, status);
+    QFETCH(QString, condition);
+    QFETCH(bool, usesNow);
+
+    QVariantMap bindings;
+    const QString sql = TaskQuery().status(static_cast<TaskQuery::StatusFilter>(status)).toSql("t.id", &bindings);
+    // 状态条件紧跟归档条件，与(is_archived, status, due_time)索引列顺序一致
+    QVERIFY(sql.contains("WHERE t.is_archived = :archived AND " + condition + " ORDER BY"));
+    QCOMPARE(bindings.contains(":now_ms"), usesNow);
+}
+
+void tst_TaskQuery::toSqlKeyword()
+{
+    QVariantMap ftsBindings;
+    const QString ftsSql = TaskQuery().keyword("周报").toSql("t.id", &ftsBindings);
+    QVERIFY(ftsSql.contains("t.id IN (SELECT rowid FROM task_search WHERE task_search MATCH :fts_match)"));
+    QCOMPARE(ftsBindings.value(":fts_match").toString(), QString("\"周报\""));
+
+    QVariantMap likeBindings;
+    const QString likeSql = TaskQuery().keyword("周报").toSql("t.id", &likeBindings, false);
+    QVERIFY(!likeSql.contains("task_search"));
+    QCOMPARE(likeBindings.value(":like_term_0").toString(), QString("%周报%"));
+
+    // 没有字母或数字的关键词不构成条件
+    QVariantMap emptyBindings;
+    QCOMPARE(TaskQuery().keyword("——").toSql("t.id", &emptyBindings), TaskQuery().toSql("t.id", &emptyBindings));
+}
+
+void tst_TaskQuery::toSqlShapeIndependentOfValues()
+{
+    // SQL只随启用的条件变化，取值只进入绑定，预编译语句可按SQL文本复用
+    QVariantMap first;
+    QVariantMap second;
+    QCOMPARE(TaskQuery().category(CategoryWork).tag("甲").idRange(0, 100).toSql("t.id", &first),
+             TaskQuery().category(CategoryLife).tag("乙").idRange(0, 200).toSql("t.id", &second));
+    QVERIFY(first != second);
+}
+
+void tst_TaskQuery::searchTerms_data()
+{
+    QTest::addColumn<QString>("text");
+    QTest::addColumn<QStringList>("terms");
+
+    QTest::newRow("空白") << "  " << QStringList();
+    QTest::newRow("大小写折叠") << "Weekly REPORT" << (QStringList() << "weekly" << "report");
+    QTest::newRow("标点分隔") << "周报-Q3，草稿" << (QStringList() << "周报" << "q3" << "草稿");
+    QTest::newRow("只有标点") << "!!! ——" << QStringList();
+}
+
+void tst_TaskQuery::searchTerms()
+{
+    QFETCH(QString, text);
+    QFETCH(QStringList, terms);
+    QCOMPARE(TaskQuery::searchTerms(text), terms);
+}
+
+void tst_TaskQuery::ftsDocument_data()
+{
+    QTest::addColumn<QString>("text");
+    QTest::addColumn<QString>("document");
+
+    QTest::newRow("空") << "" << "";
+    QTest::newRow("单字") << "周" << "周";
+    QTest::newRow("中文") << "周报告" << "周报 报告 告";
+    QTest::newRow("混合") << "Qt 周报" << "qt t 周报 报";
+    // 代理对按一个字符处理
+    QTest::newRow("扩展区汉字") << QString::fromUtf8("𠀀字") << QString::fromUtf8("𠀀字 字");
+}
+
+void tst_TaskQuery::ftsDocument()
+{
+    QFETCH(QString, text);
+    QFETCH(QString, document);
+    QCOMPARE(TaskQuery::ftsDocument(text), document);
+}
+
+void tst_TaskQuery::ftsMatchExpression_data()
+{
+    QTest::addColumn<QString>("text");
+    QTest::addColumn<QString>("match");
+
+    QTest::newRow("空") << "" << "";
+    QTest::newRow("单字前缀") << "周" << "\"周\"*";
+    QTest::newRow("两字") << "周报" << "\"周报\"";
+    QTest::newRow("多字短语") << "Report" << "\"re ep po or rt\"";
+    QTest::newRow("多个词") << "周 报告" << "\"周\"* AND \"报告\"";
+    QTest::newRow("引号不会进入表达式") << "\"a\"" << "\"a\"*";
+}
+
+void tst_TaskQuery::ftsMatchExpression()
+{
+    QFETCH(QString, text);
+    QFETCH(QString, match);
+    QCOMPARE(TaskQuery::ftsMatchExpression(text), match);
+}
+
+void tst_TaskQuery::likeCondition()
+{
+    QVariantMap bindings;
+    const QString condition = TaskQuery::likeCondition("周报 Q3", &bindings);
+    QCOMPARE(bindings.value(":like_term_0").toString(), QString("%周报%"));
+    QCOMPARE(bindings.value(":like_term_1").toString(), QString("%q3%"));
+    QCOMPARE(condition.count(" AND "), 1);
+}
+
+void tst_TaskQuery::searchSnippet()
+{
+    const QStringList terms = TaskQuery::searchTerms("report");
+    QCOMPARE(TaskQuery::searchSnippet("Weekly Report", terms, 16), QString("Weekly 【Report】"));
+    QCOMPARE(TaskQuery::searchSnippet("Weekly Report", TaskQuery::searchTerms("月报"), 16), QString());
+    QCOMPARE(TaskQuery::searchSnippet("0123456789Report", terms, 4), QString("…6789【Report】"));
+}
+
+QTEST_APPLESS_MAIN(tst_TaskQuery)
+
+#include "tst_taskquery.moc"
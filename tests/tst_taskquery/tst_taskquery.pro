@@ -0,0 +1,8 @@
+include(../tests.pri)
+
+TARGET = tst_taskquery
+
+SOURCES += \
+    tst_taskquery.cpp \
+    $$APP_DIR/task.cpp \
+    $$APP_DIR/taskquery.cpp
@@ -0,0 +1,165 @@
+#include <QtTest>
+#include <algorithm>
+#include "tasksearchindex.h"
+
+// 实时搜索索引：匹配语义（标题、备注、标签子串）与按变更通知的增量更新
+// 索引只保存任务ID，任务内容取自快照：测试中快照由setActiveTasks()维护，与变更通知保持一致
+class tst_TaskSearchIndex : public QObject
+{
+    Q_OBJECT
+
+private slots:
+    void init();
+    void matchesTitleDescriptionAndTags_data();
+    void matchesTitleDescriptionAndTags();
+    void resultsInDescendingIdOrder();
+    void appliesTaskChanges();
+    void restoredTaskKeepsTags();
+    void skipsTasksMissingFromSnapshot();
+
+private:
+    static Task makeTask(int id, const QString& title, const QString& description = QString());
+    void setActiveTasks(QList<Task> tasks);
+    QList<int> matchIds(const QString& text) const;
+
+    TaskSearchIndex m_index;
+    TaskSnapshot m_snapshot;
+};
+
+Task tst_TaskSearchIndex::makeTask(int id, const QString& title, const QString& description)
+{
+    Task task;
+    task.id = id;
+    task.title = title;
+    task.description = description;
+    return task;
+}
+
+void tst_TaskSearchIndex::setActiveTasks(QList<Task> tasks)
+{
+    // 与内存仓库的快照一致：按ID倒序
+    std::sort(tasks.begin(), tasks.end(), [](const Task& a, const Task& b) { return a.id > b.id; });
+    m_snapshot.activeTasks = tasks;
+}
+
+QList<int> tst_TaskSearchIndex::matchIds(const QString& text) const
+{
+    QList<int> ids;
+    m_index.forEachMatch(text, m_snapshot, [&](const Task& task) {
+        ids.append(task.id);
+        return true;
+    });
+    return ids;
+}
+
+void tst_TaskSearchIndex::init()
+{
+    QHash<int, QStringList> tags;
+    tags.insert(2, QStringList() << "学习" << "Qt");
+    tags.insert(3, QStringList() << "生活" << "家务");
+    setActiveTasks(QList<Task>() << makeTask(1, "编写周报告", "Report for Q3")
+                                 << makeTask(2, "阅读文档", "sqlite 全文检索")
+                                 << makeTask(3, "买菜", "牛奶、鸡蛋"));
+    m_index = TaskSearchIndex();
+    m_index.build(m_snapshot.activeTasks, tags);
+}
+
+void tst_TaskSearchIndex::matchesTitleDescriptionAndTags_data()
+{
+    QTest::addColumn<QString>("text");
+    QTest::addColumn<QList<int>>("ids");
+
+    QTest::newRow("标题单字") << "周" << (QList<int>() << 1);
+    QTest::newRow("标题子串") << "周报" << (QList<int>() << 1);
+    QTest::newRow("备注不区分大小写") << "REPORT" << (QList<int>() << 1);
+    QTest::newRow("标签") << "qt" << (QList<int>() << 2);
+    QTest::newRow("多个词分别命中不同字段") << "学习 检索" << (QList<int>() << 2);
+    QTest::newRow("标点视为分隔") << "牛奶、鸡蛋" << (QList<int>() << 3);
+    QTest::newRow("词不能跨标签") << "生活家务" << QList<int>();
+    QTest::newRow("没有字母数字") << "、、" << QList<int>();
+}
+
+void tst_TaskSearchIndex::matchesTitleDescriptionAndTags()
+{
+    QFETCH(QString, text);
+    QFETCH(QList<int>, ids);
+    QCOMPARE(matchIds(text), ids);
+}
+
+void tst_TaskSearchIndex::resultsInDescendingIdOrder()
+{
+    // 任务1与任务2的备注都含有字母e
+    QCOMPARE(matchIds("e"), QList<int>() << 2 << 1);
+}
+
+void tst_TaskSearchIndex::appliesTaskChanges()
+{
+    TaskChange inserted;
+    inserted.type = TaskChange::Inserted;
+    inserted.taskId = 4;
+    inserted.task = makeTask(4, "月报");
+
+    TaskChange updated;
+    updated.type = TaskChange::Updated;
+    updated.taskId = 1;
+    updated.task = makeTask(1, "编写月度总结");
+
+    TaskChange tagsChanged;
+    tagsChanged.type = TaskChange::TagsChanged;
+    tagsChanged.taskId = 3;
+    tagsChanged.tags = QStringList() << "购物";
+    tagsChanged.task = makeTask(3, "买菜", "牛奶、鸡蛋"); // 内存仓库应用变更后补上
+
+    TaskChange archived;
+    archived.type = TaskChange::Archived;
+    archived.taskId = 2;
+    archived.task = makeTask(2, "阅读文档");
+    archived.task.is_archived = 1;
+
+    m_index.applyChanges(QList<TaskChange>() << inserted << updated << tagsChanged << archived);
+    setActiveTasks(QList<Task>() << inserted.task << updated.task << tagsChanged.task);
+
+    QCOMPARE(matchIds("月"), QList<int>() << 4 << 1);
+    QCOMPARE(matchIds("周报"), QList<int>()); // 旧标题的字组已移除
+    QCOMPARE(matchIds("购物"), QList<int>() << 3);
+    QCOMPARE(matchIds("家务"), QList<int>());
+    QCOMPARE(matchIds("阅读"), QList<int>()); // 已归档
+
+    TaskChange deleted;
+    deleted.type = TaskChange::Deleted;
+    deleted.taskId = 4;
+    m_index.applyChanges(QList<TaskChange>() << deleted);
+    setActiveTasks(QList<Task>() << updated.task << tagsChanged.task);
+    QCOMPARE(matchIds("月"), QList<int>() << 1);
+}
+
+void tst_TaskSearchIndex::restoredTaskKeepsTags()
+{
+    TaskChange archived;
+    archived.type = TaskChange::Archived;
+    archived.taskId = 2;
+    archived.task = makeTask(2, "阅读文档");
+    archived.task.is_archived = 1;
+    m_index.applyChanges(QList<TaskChange>() << archived);
+    setActiveTasks(QList<Task>() << makeTask(1, "编写周报告", "Report for Q3") << makeTask(3, "买菜", "牛奶、鸡蛋"));
+    QCOMPARE(matchIds("qt"), QList<int>());
+
+    TaskChange restored = archived;
+    restored.type = TaskChange::Restored;
+    restored.task.is_archived = 0;
+    m_index.applyChanges(QList<TaskChange>() << restored);
+    setActiveTasks(m_snapshot.activeTasks + (QList<Task>() << restored.task));
+    QCOMPARE(matchIds("qt"), QList<int>() << 2);
+}
+
+void tst_TaskSearchIndex::skipsTasksMissingFromSnapshot()
+{
+    // 快照已不含任务3（删除通知尚未到达索引）：不返回该任务
+    setActiveTasks(QList<Task>() << makeTask(1, "编写周报告", "Report for Q3"));
+    QCOMPARE(matchIds("买菜"), QList<int>());
+    QCOMPARE(matchIds("e"), QList<int>() << 1);
+}
+
+QTEST_APPLESS_MAIN(tst_TaskSearchIndex)
+
+#include "tst_tasksearchindex.moc"
@@ -0,0 +1,13 @@
+include(../tests.pri)
+
+TARGET = tst_tasksearchindex
+
+SOURCES += \
+    tst_tasksearchindex.cpp \
+    $$APP_DIR/task.cpp \
+    $$APP_DIR/taskchangenotifier.cpp \
+    $$APP_DIR/taskquery.cpp \
+    $$APP_DIR/tasksearchindex.cpp
+
+HEADERS += \
+    $$APP_DIR/taskchangenotifier.h